@@ -0,0 +1,958 @@
+#ifndef MAU_BTREE_MAP_H
+#define MAU_BTREE_MAP_H
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#if defined(__AVX2__)
+#	define MAU_BTREE_AVX2 1
+#	include <immintrin.h>
+#endif
+
+namespace Mau
+{
+	namespace BTreeDetail
+	{
+		// 32 and 64 bit integers ordered by std::less are searched by counting with SIMD compares instead of a binary search
+		template <typename Key, typename Compare>
+		inline constexpr bool COUNTED_SEARCH{ std::is_integral_v<Key> && !std::is_same_v<Key, bool> && (sizeof(Key) == 4 || sizeof(Key) == 8)
+			&& (std::is_same_v<Compare, std::less<Key>> || std::is_same_v<Compare, std::less<>>) };
+
+		// Keys per 256 bit compare; node capacities are rounded down to a multiple of it so no load leaves the key array
+		template <typename Key, typename Compare>
+		inline constexpr size_t LANES{ COUNTED_SEARCH<Key, Compare> ? 32 / sizeof(Key) : 1 };
+
+		// Number of the first count (sorted) keys below key, or with Upper not above it: the lower_bound and
+		// upper_bound index. Every key is compared, a node is small enough that skipping the branches of a
+		// binary search pays for the extra compares.
+		template <bool Upper, typename Key>
+		[[nodiscard]] static size_t CountBelow(Key const* keys, size_t count, Key key) noexcept
+		{
+		#if defined(MAU_BTREE_AVX2)
+			constexpr size_t LANE_COUNT{ 32 / sizeof(Key) };
+
+			// Unsigned keys are compared as signed ones after flipping the sign bit
+			auto load
+			{
+				[](Key const* source)
+				{
+					__m256i const values{ _mm256_loadu_si256(reinterpret_cast<__m256i const*>(source)) };
+					if constexpr (std::is_signed_v<Key>)
+					{
+						return values;
+					}
+					else if constexpr (sizeof(Key) == 4)
+					{
+						return _mm256_xor_si256(values, _mm256_set1_epi32(INT32_MIN));
+					}
+					else
+					{
+						return _mm256_xor_si256(values, _mm256_set1_epi64x(INT64_MIN));
+					}
+				}
+			};
+
+			__m256i needle{};
+			if constexpr (sizeof(Key) == 4)
+			{
+				needle = _mm256_set1_epi32(static_cast<int32_t>(std::is_signed_v<Key> ? key : key ^ static_cast<Key>(INT32_MIN)));
+			}
+			else
+			{
+				needle = _mm256_set1_epi64x(static_cast<int64_t>(std::is_signed_v<Key> ? key : key ^ static_cast<Key>(INT64_MIN)));
+			}
+
+			// The byte mask has sizeof(Key) bits per lane
+			size_t matches{ 0 };
+			for (size_t i{ 0 }; i < count; i += LANE_COUNT)
+			{
+				__m256i const values{ load(keys + i) };
+				__m256i greater{};
+				if constexpr (sizeof(Key) == 4)
+				{
+					greater = Upper ? _mm256_cmpgt_epi32(values, needle) : _mm256_cmpgt_epi32(needle, values);
+				}
+				else
+				{
+					greater = Upper ? _mm256_cmpgt_epi64(values, needle) : _mm256_cmpgt_epi64(needle, values);
+				}
+
+				size_t const valid{ std::min(LANE_COUNT, count - i) };
+				uint32_t const validMask{ valid == LANE_COUNT ? ~0u : (1u << (valid * sizeof(Key))) - 1 };
+				matches += static_cast<size_t>(std::popcount(static_cast<uint32_t>(_mm256_movemask_epi8(greater)) & validMask)) / sizeof(Key);
+			}
+
+			// Upper counted the keys above key
+			return Upper ? count - matches : matches;
+		#else
+			size_t below{ 0 };
+			for (size_t i{ 0 }; i < count; ++i)
+			{
+				below += Upper ? !(key < keys[i]) : keys[i] < key;
+			}
+			return below;
+		#endif
+		}
+	}
+
+	// Ordered map as a B+ tree: elements live only in the leaves, which are linked in key order, and the inner nodes
+	// hold separator keys. Every node is 64 byte aligned and about NodeBytes big, with its keys stored apart from its
+	// values and children, so a node search reads a few cache lines of keys. Inserting shifts one node instead of the
+	// whole container like flat_map, and a lookup chases a pointer per level instead of per element like std::map.
+	// Inserting and erasing invalidate all iterators. Key and Mapped must be default constructible.
+	template <typename Key, typename Mapped, typename Compare = std::less<Key>, size_t NodeBytes = 512>
+	class BTreeMap final
+	{
+		static_assert(NodeBytes % 64 == 0, "BTreeMap nodes are a whole number of cache lines");
+
+		static constexpr size_t LANES{ BTreeDetail::LANES<Key, Compare> };
+
+	public:
+		// Elements per leaf and separators per inner node, also filled completely by ascending inserts
+		static constexpr size_t LEAF_CAPACITY{ (NodeBytes - 2 * sizeof(void*) - sizeof(uint16_t)) / (sizeof(Key) + sizeof(Mapped)) / LANES * LANES };
+		static constexpr size_t INNER_CAPACITY{ (NodeBytes - 2 * sizeof(void*) - sizeof(uint16_t)) / (sizeof(Key) + sizeof(void*)) / LANES * LANES };
+		static_assert(LEAF_CAPACITY >= 4 && INNER_CAPACITY >= 4, "NodeBytes is too small for Key and Mapped");
+
+	private:
+		struct alignas(64) Leaf final
+		{
+			Key keys[LEAF_CAPACITY]{};
+			Mapped values[LEAF_CAPACITY]{};
+			Leaf* prev{ nullptr };
+			Leaf* next{ nullptr };
+			uint16_t count{ 0 };
+		};
+
+		// Every key of children[i] is below keys[i], every key of children[i + 1] is not
+		struct alignas(64) Inner final
+		{
+			Key keys[INNER_CAPACITY]{};
+			void* children[INNER_CAPACITY + 1]{};
+			uint16_t count{ 0 };
+		};
+
+		// Below these a node borrows from or merges with a sibling after an erase
+		static constexpr size_t MIN_LEAF{ LEAF_CAPACITY / 2 };
+		static constexpr size_t MIN_INNER{ INNER_CAPACITY / 2 };
+
+		// Inner nodes have at least two children, so the height stays below the bit count of the size
+		static constexpr size_t MAX_HEIGHT{ 64 };
+
+		// The inner nodes from the root down to a leaf and the child taken in each
+		struct Path final
+		{
+			Inner* nodes[MAX_HEIGHT];
+			uint16_t children[MAX_HEIGHT];
+		};
+
+	public:
+		using key_type = Key;
+		using mapped_type = Mapped;
+		using value_type = std::pair<Key, Mapped>;
+		using key_compare = Compare;
+		using size_type = size_t;
+
+		// Leaf and index in it. The end iterator points one past the last leaf's last element,
+		// so stepping only checks for the end of a leaf.
+		template <bool Const>
+		class Iterator final
+		{
+		public:
+			using iterator_category = std::bidirectional_iterator_tag;
+			using value_type = std::pair<Key, Mapped>;
+			using difference_type = ptrdiff_t;
+			using reference = std::pair<Key const&, std::conditional_t<Const, Mapped const&, Mapped&>>;
+
+			struct pointer final
+			{
+				reference ref;
+
+				reference const* operator->() const noexcept
+				{
+					return &ref;
+				}
+			};
+
+			Iterator() noexcept = default;
+
+			// iterator converts to const_iterator
+			template <bool OtherConst, typename = std::enable_if_t<Const && !OtherConst>>
+			Iterator(Iterator<OtherConst> const& other) noexcept
+				: m_Leaf{ other.m_Leaf }
+				, m_Index{ other.m_Index }
+			{
+			}
+
+			[[nodiscard]] reference operator*() const noexcept
+			{
+				return { m_Leaf->keys[m_Index], m_Leaf->values[m_Index] };
+			}
+
+			[[nodiscard]] pointer operator->() const noexcept
+			{
+				return { **this };
+			}
+
+			Iterator& operator++() noexcept
+			{
+				if (++m_Index == m_Leaf->count && m_Leaf->next != nullptr)
+				{
+					m_Leaf = m_Leaf->next;
+					m_Index = 0;
+				}
+				return *this;
+			}
+
+			Iterator operator++(int) noexcept
+			{
+				Iterator const old{ *this };
+				++*this;
+				return old;
+			}
+
+			Iterator& operator--() noexcept
+			{
+				if (m_Index == 0)
+				{
+					m_Leaf = m_Leaf->prev;
+					m_Index = m_Leaf->count;
+				}
+				--m_Index;
+				return *this;
+			}
+
+			Iterator operator--(int) noexcept
+			{
+				Iterator const old{ *this };
+				--*this;
+				return old;
+			}
+
+			[[nodiscard]] bool operator==(Iterator const& other) const noexcept
+			{
+				return m_Leaf == other.m_Leaf && m_Index == other.m_Index;
+			}
+
+		private:
+			friend class BTreeMap;
+			template <bool>
+			friend class Iterator;
+
+			using LeafPointer = std::conditional_t<Const, Leaf const*, Leaf*>;
+
+			Iterator(LeafPointer leaf, size_t index) noexcept
+				: m_Leaf{ leaf }
+				, m_Index{ index }
+			{
+			}
+
+			LeafPointer m_Leaf{ nullptr };
+			size_t m_Index{ 0 };
+		};
+		using iterator = Iterator<false>;
+		using const_iterator = Iterator<true>;
+
+		BTreeMap() = default;
+
+		explicit BTreeMap(Compare const& compare)
+			: m_Compare{ compare }
+		{
+		}
+
+		template <typename InputIt>
+		BTreeMap(InputIt first, InputIt last, Compare const& compare = {})
+			: m_Compare{ compare }
+		{
+			insert(first, last);
+		}
+
+		// Inserted in order, which fills the leaves completely
+		BTreeMap(BTreeMap const& other)
+			: m_Compare{ other.m_Compare }
+		{
+			for (auto const& [key, value] : other)
+			{
+				TryEmplace(key, value);
+			}
+		}
+
+		BTreeMap(BTreeMap&& other) noexcept
+		{
+			swap(other);
+		}
+
+		BTreeMap& operator=(BTreeMap const& other)
+		{
+			if (this != &other)
+			{
+				BTreeMap copy{ other };
+				swap(copy);
+			}
+			return *this;
+		}
+
+		BTreeMap& operator=(BTreeMap&& other) noexcept
+		{
+			BTreeMap moved{ std::move(other) };
+			swap(moved);
+			return *this;
+		}
+
+		~BTreeMap()
+		{
+			clear();
+		}
+
+		[[nodiscard]] iterator begin() noexcept
+		{
+			return { m_First, 0 };
+		}
+
+		[[nodiscard]] const_iterator begin() const noexcept
+		{
+			return { m_First, 0 };
+		}
+
+		[[nodiscard]] iterator end() noexcept
+		{
+			return { m_Last, m_Last == nullptr ? size_t{ 0 } : size_t{ m_Last->count } };
+		}
+
+		[[nodiscard]] const_iterator end() const noexcept
+		{
+			return { m_Last, m_Last == nullptr ? size_t{ 0 } : size_t{ m_Last->count } };
+		}
+
+		[[nodiscard]] bool empty() const noexcept
+		{
+			return m_Size == 0;
+		}
+
+		[[nodiscard]] size_t size() const noexcept
+		{
+			return m_Size;
+		}
+
+		// Inner levels above the leaves
+		[[nodiscard]] size_t height() const noexcept
+		{
+			return m_Height;
+		}
+
+		[[nodiscard]] key_compare key_comp() const
+		{
+			return m_Compare;
+		}
+
+		template <typename... Args>
+		std::pair<iterator, bool> try_emplace(Key const& key, Args&&... args)
+		{
+			return TryEmplace(key, std::forward<Args>(args)...);
+		}
+
+		template <typename... Args>
+		std::pair<iterator, bool> try_emplace(Key&& key, Args&&... args)
+		{
+			return TryEmplace(std::move(key), std::forward<Args>(args)...);
+		}
+
+		template <typename K, typename M>
+		std::pair<iterator, bool> emplace(K&& key, M&& mapped)
+		{
+			return TryEmplace(Key(std::forward<K>(key)), std::forward<M>(mapped));
+		}
+
+		std::pair<iterator, bool> insert(std::pair<Key, Mapped> const& value)
+		{
+			return TryEmplace(value.first, value.second);
+		}
+
+		template <typename InputIt>
+		void insert(InputIt first, InputIt last)
+		{
+			for (; first != last; ++first)
+			{
+				TryEmplace((*first).first, (*first).second);
+			}
+		}
+
+		Mapped& operator[](Key const& key)
+		{
+			return TryEmplace(key).first->second;
+		}
+
+		[[nodiscard]] iterator find(Key const& key)
+		{
+			auto const [leaf, index]{ FindElement(key) };
+			return leaf == nullptr ? end() : iterator{ leaf, index };
+		}
+
+		[[nodiscard]] const_iterator find(Key const& key) const
+		{
+			auto const [leaf, index]{ FindElement(key) };
+			return leaf == nullptr ? end() : const_iterator{ leaf, index };
+		}
+
+		[[nodiscard]] bool contains(Key const& key) const
+		{
+			return FindElement(key).first != nullptr;
+		}
+
+		[[nodiscard]] size_t count(Key const& key) const
+		{
+			return contains(key) ? 1 : 0;
+		}
+
+		[[nodiscard]] Mapped& at(Key const& key)
+		{
+			auto const [leaf, index]{ FindElement(key) };
+			if (leaf == nullptr)
+			{
+				throw std::out_of_range{ "BTreeMap::at" };
+			}
+			return leaf->values[index];
+		}
+
+		[[nodiscard]] Mapped const& at(Key const& key) const
+		{
+			auto const [leaf, index]{ FindElement(key) };
+			if (leaf == nullptr)
+			{
+				throw std::out_of_range{ "BTreeMap::at" };
+			}
+			return leaf->values[index];
+		}
+
+		// First element not below key; a range scan continues from here through the linked leaves
+		[[nodiscard]] iterator lower_bound(Key const& key)
+		{
+			return Bound<false, iterator>(key);
+		}
+
+		[[nodiscard]] const_iterator lower_bound(Key const& key) const
+		{
+			return Bound<false, const_iterator>(key);
+		}
+
+		[[nodiscard]] iterator upper_bound(Key const& key)
+		{
+			return Bound<true, iterator>(key);
+		}
+
+		[[nodiscard]] const_iterator upper_bound(Key const& key) const
+		{
+			return Bound<true, const_iterator>(key);
+		}
+
+		[[nodiscard]] std::pair<iterator, iterator> equal_range(Key const& key)
+		{
+			iterator const first{ lower_bound(key) };
+			iterator last{ first };
+			if (last != end() && !m_Compare(key, last->first))
+			{
+				++last;
+			}
+			return { first, last };
+		}
+
+		[[nodiscard]] std::pair<const_iterator, const_iterator> equal_range(Key const& key) const
+		{
+			const_iterator const first{ lower_bound(key) };
+			const_iterator last{ first };
+			if (last != end() && !m_Compare(key, last->first))
+			{
+				++last;
+			}
+			return { first, last };
+		}
+
+		size_t erase(Key const& key)
+		{
+			if (m_Root == nullptr)
+			{
+				return 0;
+			}
+
+			Path path;
+			Leaf* const leaf{ Descend(key, path) };
+			size_t const index{ LeafBound<false>(leaf, key) };
+			if (index == leaf->count || m_Compare(key, leaf->keys[index]))
+			{
+				return 0;
+			}
+
+			std::move(leaf->keys + index + 1, leaf->keys + leaf->count, leaf->keys + index);
+			std::move(leaf->values + index + 1, leaf->values + leaf->count, leaf->values + index);
+			--leaf->count;
+			--m_Size;
+
+			RebalanceLeaf(leaf, path);
+			return 1;
+		}
+
+		// Rebalancing may move the following element to another leaf, so it is looked up again by its key
+		iterator erase(const_iterator position)
+		{
+			const_iterator next{ position };
+			++next;
+			if (next == end())
+			{
+				erase(Key(position->first));
+				return end();
+			}
+
+			Key const nextKey(next->first);
+			erase(Key(position->first));
+			return lower_bound(nextKey);
+		}
+
+		void clear() noexcept
+		{
+			if (m_Root != nullptr)
+			{
+				FreeSubtree(m_Root, m_Height);
+			}
+			m_Root = nullptr;
+			m_First = nullptr;
+			m_Last = nullptr;
+			m_Size = 0;
+			m_Height = 0;
+		}
+
+		void swap(BTreeMap& other) noexcept
+		{
+			using std::swap;
+			swap(m_Root, other.m_Root);
+			swap(m_First, other.m_First);
+			swap(m_Last, other.m_Last);
+			swap(m_Size, other.m_Size);
+			swap(m_Height, other.m_Height);
+			swap(m_Compare, other.m_Compare);
+		}
+
+	private:
+		void* m_Root{ nullptr };
+		Leaf* m_First{ nullptr };
+		Leaf* m_Last{ nullptr };
+		size_t m_Size{ 0 };
+		size_t m_Height{ 0 };
+		[[no_unique_address]] Compare m_Compare{};
+
+		// Number of the first count keys below key (Upper: not above it)
+		template <bool Upper>
+		[[nodiscard]] size_t Rank(Key const* keys, size_t count, Key const& key) const noexcept
+		{
+			if constexpr (BTreeDetail::COUNTED_SEARCH<Key, Compare>)
+			{
+				return BTreeDetail::CountBelow<Upper>(keys, count, key);
+			}
+			else if constexpr (Upper)
+			{
+				return static_cast<size_t>(std::upper_bound(keys, keys + count, key, m_Compare) - keys);
+			}
+			else
+			{
+				return static_cast<size_t>(std::lower_bound(keys, keys + count, key, m_Compare) - keys);
+			}
+		}
+
+		template <bool Upper>
+		[[nodiscard]] size_t LeafBound(Leaf const* leaf, Key const& key) const noexcept
+		{
+			return Rank<Upper>(leaf->keys, leaf->count, key);
+		}
+
+		// The only leaf that can hold key
+		[[nodiscard]] Leaf* FindLeaf(Key const& key) const noexcept
+		{
+			void* node{ m_Root };
+			for (size_t level{ 0 }; level < m_Height; ++level)
+			{
+				Inner const* const inner{ static_cast<Inner const*>(node) };
+				node = inner->children[Rank<true>(inner->keys, inner->count, key)];
+			}
+			return static_cast<Leaf*>(node);
+		}
+
+		// Same as FindLeaf, remembering the way down for a split or merge
+		[[nodiscard]] Leaf* Descend(Key const& key, Path& path) const noexcept
+		{
+			void* node{ m_Root };
+			for (size_t level{ 0 }; level < m_Height; ++level)
+			{
+				Inner* const inner{ static_cast<Inner*>(node) };
+				size_t const child{ Rank<true>(inner->keys, inner->count, key) };
+				path.nodes[level] = inner;
+				path.children[level] = static_cast<uint16_t>(child);
+				node = inner->children[child];
+			}
+			return static_cast<Leaf*>(node);
+		}
+
+		// Leaf and index of key, a null leaf when it is not in the map
+		[[nodiscard]] std::pair<Leaf*, size_t> FindElement(Key const& key) const noexcept
+		{
+			if (m_Root == nullptr)
+			{
+				return { nullptr, 0 };
+			}
+
+			Leaf* const leaf{ FindLeaf(key) };
+			size_t const index{ LeafBound<false>(leaf, key) };
+			if (index == leaf->count || m_Compare(key, leaf->keys[index]))
+			{
+				return { nullptr, 0 };
+			}
+			return { leaf, index };
+		}
+
+		// A bound past the last key of a leaf is the first element of the next one
+		template <bool Upper, typename It>
+		[[nodiscard]] It Bound(Key const& key) const noexcept
+		{
+			if (m_Root == nullptr)
+			{
+				return {};
+			}
+
+			Leaf* leaf{ FindLeaf(key) };
+			size_t index{ LeafBound<Upper>(leaf, key) };
+			if (index == leaf->count && leaf->next != nullptr)
+			{
+				leaf = leaf->next;
+				index = 0;
+			}
+			return { leaf, index };
+		}
+
+		template <typename K, typename... Args>
+		std::pair<iterator, bool> TryEmplace(K&& key, Args&&... args)
+		{
+			if (m_Root == nullptr)
+			{
+				Leaf* const leaf{ new Leaf{} };
+				m_Root = leaf;
+				m_First = leaf;
+				m_Last = leaf;
+			}
+
+			Path path;
+			Leaf* const leaf{ Descend(key, path) };
+			size_t const index{ LeafBound<false>(leaf, key) };
+			if (index != leaf->count && !m_Compare(key, leaf->keys[index]))
+			{
+				return { iterator{ leaf, index }, false };
+			}
+
+			// Built before anything moves, a throwing constructor leaves the map unchanged
+			Key newKey(std::forward<K>(key));
+			Mapped newValue(std::forward<Args>(args)...);
+
+			if (leaf->count == LEAF_CAPACITY)
+			{
+				auto const [target, targetIndex]{ SplitLeafAndInsert(leaf, index, path, std::move(newKey), std::move(newValue)) };
+				++m_Size;
+				return { iterator{ target, targetIndex }, true };
+			}
+
+			InsertIntoLeaf(leaf, index, std::move(newKey), std::move(newValue));
+			++m_Size;
+			return { iterator{ leaf, index }, true };
+		}
+
+		static void InsertIntoLeaf(Leaf* leaf, size_t index, Key&& key, Mapped&& value) noexcept
+		{
+			std::move_backward(leaf->keys + index, leaf->keys + leaf->count, leaf->keys + leaf->count + 1);
+			std::move_backward(leaf->values + index, leaf->values + leaf->count, leaf->values + leaf->count + 1);
+			leaf->keys[index] = std::move(key);
+			leaf->values[index] = std::move(value);
+			++leaf->count;
+		}
+
+		// Separator at keys[position] and child right behind it, the node has room for them
+		static void InsertIntoInner(Inner* node, size_t position, Key&& separator, void* child) noexcept
+		{
+			std::move_backward(node->keys + position, node->keys + node->count, node->keys + node->count + 1);
+			std::move_backward(node->children + position + 1, node->children + node->count + 1, node->children + node->count + 2);
+			node->keys[position] = std::move(separator);
+			node->children[position + 1] = child;
+			++node->count;
+		}
+
+		// Splits the full leaf, inserts the element and returns where it went. Appending to the last leaf
+		// (or prepending to the first) starts a new leaf instead of halving, so sorted inserts fill every leaf.
+		// All nodes are allocated before the tree changes, so a failed allocation leaves it intact.
+		std::pair<Leaf*, size_t> SplitLeafAndInsert(Leaf* leaf, size_t index, Path const& path, Key&& key, Mapped&& value)
+		{
+			size_t fullParents{ 0 };
+			while (fullParents < m_Height && path.nodes[m_Height - 1 - fullParents]->count == INNER_CAPACITY)
+			{
+				++fullParents;
+			}
+
+			auto right{ std::make_unique<Leaf>() };
+			std::unique_ptr<Inner> spare[MAX_HEIGHT + 1];
+			for (size_t i{ 0 }; i < fullParents + (fullParents == m_Height ? 1 : 0); ++i)
+			{
+				spare[i] = std::make_unique<Inner>();
+			}
+
+			size_t split{ LEAF_CAPACITY / 2 };
+			if (index == LEAF_CAPACITY && leaf->next == nullptr)
+			{
+				split = LEAF_CAPACITY;
+			}
+			else if (index == 0 && leaf->prev == nullptr)
+			{
+				split = 0;
+			}
+
+			Leaf* const newLeaf{ right.release() };
+			std::move(leaf->keys + split, leaf->keys + LEAF_CAPACITY, newLeaf->keys);
+			std::move(leaf->values + split, leaf->values + LEAF_CAPACITY, newLeaf->values);
+			newLeaf->count = static_cast<uint16_t>(LEAF_CAPACITY - split);
+			leaf->count = static_cast<uint16_t>(split);
+
+			newLeaf->prev = leaf;
+			newLeaf->next = leaf->next;
+			if (leaf->next != nullptr)
+			{
+				leaf->next->prev = newLeaf;
+			}
+			else
+			{
+				m_Last = newLeaf;
+			}
+			leaf->next = newLeaf;
+
+			bool const toLeft{ index < split || (index == split && split != LEAF_CAPACITY) };
+			Leaf* const target{ toLeft ? leaf : newLeaf };
+			size_t const targetIndex{ toLeft ? index : index - split };
+			InsertIntoLeaf(target, targetIndex, std::move(key), std::move(value));
+
+			InsertSeparator(path, Key(newLeaf->keys[0]), newLeaf, spare);
+			return { target, targetIndex };
+		}
+
+		// Adds the separator and new child to the parent of the split node, splitting full inner nodes
+		// on the way up and growing a new root when the old one splits as well
+		void InsertSeparator(Path const& path, Key separator, void* child, std::unique_ptr<Inner>* spare) noexcept
+		{
+			for (size_t level{ m_Height }; level-- > 0;)
+			{
+				Inner* const node{ path.nodes[level] };
+				size_t const position{ path.children[level] };
+				if (node->count < INNER_CAPACITY)
+				{
+					InsertIntoInner(node, position, std::move(separator), child);
+					return;
+				}
+
+				// The INNER_CAPACITY + 1 separators in order, the middle one moves up
+				Key keys[INNER_CAPACITY + 1];
+				void* children[INNER_CAPACITY + 2];
+				std::move(node->keys, node->keys + position, keys);
+				keys[position] = std::move(separator);
+				std::move(node->keys + position, node->keys + INNER_CAPACITY, keys + position + 1);
+				std::copy(node->children, node->children + position + 1, children);
+				children[position + 1] = child;
+				std::copy(node->children + position + 1, node->children + INNER_CAPACITY + 1, children + position + 2);
+
+				constexpr size_t MIDDLE{ (INNER_CAPACITY + 1) / 2 };
+				Inner* const right{ (spare++)->release() };
+				std::move(keys, keys + MIDDLE, node->keys);
+				std::copy(children, children + MIDDLE + 1, node->children);
+				node->count = static_cast<uint16_t>(MIDDLE);
+				std::move(keys + MIDDLE + 1, keys + INNER_CAPACITY + 1, right->keys);
+				std::copy(children + MIDDLE + 1, children + INNER_CAPACITY + 2, right->children);
+				right->count = static_cast<uint16_t>(INNER_CAPACITY - MIDDLE);
+
+				separator = std::move(keys[MIDDLE]);
+				child = right;
+			}
+
+			Inner* const root{ spare->release() };
+			root->keys[0] = std::move(separator);
+			root->children[0] = m_Root;
+			root->children[1] = child;
+			root->count = 1;
+			m_Root = root;
+			++m_Height;
+		}
+
+		// An underfull leaf takes an element from a sibling that can spare one, or else merges with it.
+		// Separators only need to split the key ranges, so they are updated only when a first key moves.
+		void RebalanceLeaf(Leaf* leaf, Path const& path) noexcept
+		{
+			if (m_Height == 0 || leaf->count >= MIN_LEAF)
+			{
+				return;
+			}
+
+			Inner* const parent{ path.nodes[m_Height - 1] };
+			size_t const child{ path.children[m_Height - 1] };
+			Leaf* const left{ child > 0 ? static_cast<Leaf*>(parent->children[child - 1]) : nullptr };
+			Leaf* const right{ child < parent->count ? static_cast<Leaf*>(parent->children[child + 1]) : nullptr };
+
+			if (left != nullptr && left->count > MIN_LEAF)
+			{
+				std::move_backward(leaf->keys, leaf->keys + leaf->count, leaf->keys + leaf->count + 1);
+				std::move_backward(leaf->values, leaf->values + leaf->count, leaf->values + leaf->count + 1);
+				--left->count;
+				leaf->keys[0] = std::move(left->keys[left->count]);
+				leaf->values[0] = std::move(left->values[left->count]);
+				++leaf->count;
+				parent->keys[child - 1] = leaf->keys[0];
+				return;
+			}
+
+			if (right != nullptr && right->count > MIN_LEAF)
+			{
+				leaf->keys[leaf->count] = std::move(right->keys[0]);
+				leaf->values[leaf->count] = std::move(right->values[0]);
+				++leaf->count;
+				std::move(right->keys + 1, right->keys + right->count, right->keys);
+				std::move(right->values + 1, right->values + right->count, right->values);
+				--right->count;
+				parent->keys[child] = right->keys[0];
+				return;
+			}
+
+			if (left != nullptr)
+			{
+				MergeLeaves(left, leaf);
+				RemoveFromInner(parent, child - 1);
+			}
+			else
+			{
+				MergeLeaves(leaf, right);
+				RemoveFromInner(parent, child);
+			}
+			RebalanceInner(path, m_Height - 1);
+		}
+
+		// Moves all of right into left and unlinks it
+		void MergeLeaves(Leaf* left, Leaf* right) noexcept
+		{
+			std::move(right->keys, right->keys + right->count, left->keys + left->count);
+			std::move(right->values, right->values + right->count, left->values + left->count);
+			left->count = static_cast<uint16_t>(left->count + right->count);
+
+			left->next = right->next;
+			if (right->next != nullptr)
+			{
+				right->next->prev = left;
+			}
+			else
+			{
+				m_Last = left;
+			}
+			delete right;
+		}
+
+		// Drops keys[position] and the child behind it
+		static void RemoveFromInner(Inner* node, size_t position) noexcept
+		{
+			std::move(node->keys + position + 1, node->keys + node->count, node->keys + position);
+			std::copy(node->children + position + 2, node->children + node->count + 1, node->children + position + 1);
+			--node->count;
+		}
+
+		// Same as RebalanceLeaf one level up: a separator rotates through the parent when borrowing, and is pulled
+		// down between the two nodes when merging. A root left with a single child is replaced by it.
+		void RebalanceInner(Path const& path, size_t level) noexcept
+		{
+			Inner* const node{ path.nodes[level] };
+			if (level == 0)
+			{
+				if (node->count == 0)
+				{
+					m_Root = node->children[0];
+					--m_Height;
+					delete node;
+				}
+				return;
+			}
+			if (node->count >= MIN_INNER)
+			{
+				return;
+			}
+
+			Inner* const parent{ path.nodes[level - 1] };
+			size_t const child{ path.children[level - 1] };
+			Inner* const left{ child > 0 ? static_cast<Inner*>(parent->children[child - 1]) : nullptr };
+			Inner* const right{ child < parent->count ? static_cast<Inner*>(parent->children[child + 1]) : nullptr };
+
+			if (left != nullptr && left->count > MIN_INNER)
+			{
+				std::move_backward(node->keys, node->keys + node->count, node->keys + node->count + 1);
+				std::copy_backward(node->children, node->children + node->count + 1, node->children + node->count + 2);
+				node->keys[0] = std::move(parent->keys[child - 1]);
+				node->children[0] = left->children[left->count];
+				++node->count;
+				parent->keys[child - 1] = std::move(left->keys[left->count - 1]);
+				--left->count;
+				return;
+			}
+
+			if (right != nullptr && right->count > MIN_INNER)
+			{
+				node->keys[node->count] = std::move(parent->keys[child]);
+				node->children[node->count + 1] = right->children[0];
+				++node->count;
+				parent->keys[child] = std::move(right->keys[0]);
+				std::move(right->keys + 1, right->keys + right->count, right->keys);
+				std::copy(right->children + 1, right->children + right->count + 1, right->children);
+				--right->count;
+				return;
+			}
+
+			if (left != nullptr)
+			{
+				MergeInners(left, std::move(parent->keys[child - 1]), node);
+				RemoveFromInner(parent, child - 1);
+			}
+			else
+			{
+				MergeInners(node, std::move(parent->keys[child]), right);
+				RemoveFromInner(parent, child);
+			}
+			RebalanceInner(path, level - 1);
+		}
+
+		static void MergeInners(Inner* left, Key&& separator, Inner* right) noexcept
+		{
+			left->keys[left->count] = std::move(separator);
+			std::move(right->keys, right->keys + right->count, left->keys + left->count + 1);
+			std::copy(right->children, right->children + right->count + 1, left->children + left->count + 1);
+			left->count = static_cast<uint16_t>(left->count + 1 + right->count);
+			delete right;
+		}
+
+		void FreeSubtree(void* node, size_t levels) noexcept
+		{
+			if (levels == 0)
+			{
+				delete static_cast<Leaf*>(node);
+				return;
+			}
+
+			Inner* const inner{ static_cast<Inner*>(node) };
+			for (size_t i{ 0 }; i <= inner->count; ++i)
+			{
+				FreeSubtree(inner->children[i], levels - 1);
+			}
+			delete inner;
+		}
+	};
+}
+
+#endif
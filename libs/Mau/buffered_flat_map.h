@@ -0,0 +1,287 @@
+#ifndef MAU_BUFFERED_FLAT_MAP_H
+#define MAU_BUFFERED_FLAT_MAP_H
+
+#include <SG14/flat_map.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace Mau
+{
+	// Sorted map for write-heavy workloads, stored like stdext::flat_map in a key and a mapped container.
+	// The elements are a large sorted run followed by a small sorted insert buffer: a new key only shifts the buffer,
+	// not the whole map. Once the buffer grows past about the square root of the sorted run, both are merged
+	// in one pass (flatmap_detail::merge_tail), so a random-order insert costs O(sqrt(n)) moves instead of O(n).
+	// Lookups search both runs. begin() and the ordered queries merge the buffer first; like an insert,
+	// that invalidates iterators, and it is not safe to call them concurrently with other readers before a flush().
+	template <typename Key, typename Mapped, typename Compare = std::less<Key>, typename KeyContainer = std::vector<Key>, typename MappedContainer = std::vector<Mapped>>
+	class BufferedFlatMap final
+	{
+	public:
+		using key_type = Key;
+		using mapped_type = Mapped;
+		using key_compare = Compare;
+		using size_type = size_t;
+		using iterator = stdext::flatmap_detail::iter<typename KeyContainer::const_iterator, typename MappedContainer::iterator>;
+		using const_iterator = stdext::flatmap_detail::iter<typename KeyContainer::const_iterator, typename MappedContainer::const_iterator>;
+
+		BufferedFlatMap() = default;
+
+		explicit BufferedFlatMap(Compare const& compare)
+			: m_Compare{ compare }
+		{
+		}
+
+		[[nodiscard]] iterator begin()
+		{
+			flush();
+			return stdext::flatmap_detail::make_iterator(m_Keys.begin(), m_Values.begin());
+		}
+
+		[[nodiscard]] const_iterator begin() const
+		{
+			flush();
+			return stdext::flatmap_detail::make_iterator(m_Keys.begin(), m_Values.begin());
+		}
+
+		// Does not merge: the size is the same either way, and find() results compared against end() stay valid
+		[[nodiscard]] iterator end() noexcept
+		{
+			return stdext::flatmap_detail::make_iterator(m_Keys.end(), m_Values.end());
+		}
+
+		[[nodiscard]] const_iterator end() const noexcept
+		{
+			return stdext::flatmap_detail::make_iterator(m_Keys.end(), m_Values.end());
+		}
+
+		[[nodiscard]] bool empty() const noexcept
+		{
+			return m_Keys.empty();
+		}
+
+		[[nodiscard]] size_t size() const noexcept
+		{
+			return m_Keys.size();
+		}
+
+		// Elements inserted since the last merge
+		[[nodiscard]] size_t buffer_size() const noexcept
+		{
+			return m_Keys.size() - m_SortedSize;
+		}
+
+		template <typename... Args>
+		std::pair<iterator, bool> try_emplace(Key const& key, Args&&... args)
+		{
+			return TryEmplace(key, std::forward<Args>(args)...);
+		}
+
+		template <typename... Args>
+		std::pair<iterator, bool> try_emplace(Key&& key, Args&&... args)
+		{
+			return TryEmplace(std::move(key), std::forward<Args>(args)...);
+		}
+
+		template <typename K, typename M>
+		std::pair<iterator, bool> emplace(K&& key, M&& mapped)
+		{
+			return TryEmplace(Key(std::forward<K>(key)), std::forward<M>(mapped));
+		}
+
+		std::pair<iterator, bool> insert(std::pair<Key, Mapped> const& value)
+		{
+			return TryEmplace(value.first, value.second);
+		}
+
+		Mapped& operator[](Key const& key)
+		{
+			return try_emplace(key).first->second;
+		}
+
+		[[nodiscard]] iterator find(Key const& key)
+		{
+			return IteratorAt(FindIndex(key));
+		}
+
+		[[nodiscard]] const_iterator find(Key const& key) const
+		{
+			return IteratorAt(FindIndex(key));
+		}
+
+		[[nodiscard]] bool contains(Key const& key) const
+		{
+			return FindIndex(key) != m_Keys.size();
+		}
+
+		[[nodiscard]] size_t count(Key const& key) const
+		{
+			return contains(key) ? 1 : 0;
+		}
+
+		[[nodiscard]] Mapped& at(Key const& key)
+		{
+			size_t const index{ FindIndex(key) };
+			if (index == m_Keys.size())
+			{
+				throw std::out_of_range{ "BufferedFlatMap::at" };
+			}
+			return m_Values[index];
+		}
+
+		[[nodiscard]] Mapped const& at(Key const& key) const
+		{
+			size_t const index{ FindIndex(key) };
+			if (index == m_Keys.size())
+			{
+				throw std::out_of_range{ "BufferedFlatMap::at" };
+			}
+			return m_Values[index];
+		}
+
+		[[nodiscard]] iterator lower_bound(Key const& key)
+		{
+			flush();
+			return IteratorAt(LowerBoundIndex(0, m_Keys.size(), key));
+		}
+
+		[[nodiscard]] iterator upper_bound(Key const& key)
+		{
+			flush();
+			auto const it{ std::upper_bound(m_Keys.begin(), m_Keys.end(), key, std::ref(m_Compare)) };
+			return IteratorAt(static_cast<size_t>(it - m_Keys.begin()));
+		}
+
+		size_t erase(Key const& key)
+		{
+			size_t const index{ FindIndex(key) };
+			if (index == m_Keys.size())
+			{
+				return 0;
+			}
+
+			m_Keys.erase(m_Keys.begin() + index);
+			m_Values.erase(m_Values.begin() + index);
+			if (index < m_SortedSize)
+			{
+				--m_SortedSize;
+			}
+			return 1;
+		}
+
+		void clear() noexcept
+		{
+			m_Keys.clear();
+			m_Values.clear();
+			m_SortedSize = 0;
+			m_MaxBufferSize = MIN_BUFFER_SIZE;
+		}
+
+		// Merges the insert buffer into the sorted run
+		void flush() const
+		{
+			if (m_SortedSize == m_Keys.size())
+			{
+				return;
+			}
+
+			stdext::flatmap_detail::merge_tail(m_Compare, m_SortedSize, m_Keys, m_Values);
+			m_SortedSize = m_Keys.size();
+
+			// Balances the cost of shifting the buffer on every insert against merging the whole map once per buffer
+			m_MaxBufferSize = std::max(MIN_BUFFER_SIZE, static_cast<size_t>(std::sqrt(static_cast<double>(m_SortedSize))));
+		}
+
+	private:
+		static constexpr size_t MIN_BUFFER_SIZE{ 64 };
+
+		// Mutable so const ordered access can merge the buffer, the contents do not change
+		mutable KeyContainer m_Keys;
+		mutable MappedContainer m_Values;
+		mutable size_t m_SortedSize{ 0 };
+		mutable size_t m_MaxBufferSize{ MIN_BUFFER_SIZE };
+		[[no_unique_address]] mutable Compare m_Compare{};
+
+		[[nodiscard]] iterator IteratorAt(size_t index) const noexcept
+		{
+			return stdext::flatmap_detail::make_iterator(m_Keys.begin(), m_Values.begin()) + static_cast<ptrdiff_t>(index);
+		}
+
+		// Index of the first key in [first, last) not less than key
+		[[nodiscard]] size_t LowerBoundIndex(size_t first, size_t last, Key const& key) const
+		{
+			if constexpr (stdext::flatmap_detail::uses_branchless_search<Key, Compare, KeyContainer>::value)
+			{
+				return first + stdext::flatmap_detail::branchless_lower_bound(m_Keys.data() + first, last - first, key);
+			}
+			else
+			{
+				auto const it{ std::partition_point(m_Keys.begin() + first, m_Keys.begin() + last, [this, &key](Key const& element)
+				{
+					return bool(m_Compare(element, key));
+				}) };
+				return static_cast<size_t>(it - m_Keys.begin());
+			}
+		}
+
+		// Index of key in either run, size() when it is not present
+		[[nodiscard]] size_t FindIndex(Key const& key) const
+		{
+			size_t index{ LowerBoundIndex(0, m_SortedSize, key) };
+			if (index != m_SortedSize && !m_Compare(key, m_Keys[index]))
+			{
+				return index;
+			}
+
+			index = LowerBoundIndex(m_SortedSize, m_Keys.size(), key);
+			if (index != m_Keys.size() && !m_Compare(key, m_Keys[index]))
+			{
+				return index;
+			}
+			return m_Keys.size();
+		}
+
+		template <typename K, typename... Args>
+		std::pair<iterator, bool> TryEmplace(K&& key, Args&&... args)
+		{
+			size_t index{ LowerBoundIndex(0, m_SortedSize, key) };
+			if (index != m_SortedSize && !m_Compare(key, m_Keys[index]))
+			{
+				return { IteratorAt(index), false };
+			}
+
+			index = LowerBoundIndex(m_SortedSize, m_Keys.size(), key);
+			if (index != m_Keys.size() && !m_Compare(key, m_Keys[index]))
+			{
+				return { IteratorAt(index), false };
+			}
+
+			// Only the buffer behind index moves
+			m_Keys.insert(m_Keys.begin() + index, std::forward<K>(key));
+			try
+			{
+				m_Values.emplace(m_Values.begin() + index, std::forward<Args>(args)...);
+			}
+			catch (...)
+			{
+				m_Keys.erase(m_Keys.begin() + index);
+				throw;
+			}
+
+			if (buffer_size() > m_MaxBufferSize)
+			{
+				Key const inserted{ m_Keys[index] };
+				flush();
+				return { IteratorAt(LowerBoundIndex(0, m_Keys.size(), inserted)), true };
+			}
+			return { IteratorAt(index), true };
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,242 @@
+#ifndef MAU_EYTZINGER_MAP_H
+#define MAU_EYTZINGER_MAP_H
+
+#include <SG14/flat_map.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#	include <xmmintrin.h>
+#endif
+
+namespace Mau
+{
+	// Storage for the key array: 64 byte aligned, so the descendants of a node that share a cache line in
+	// Eytzinger order really are in a single line
+	template <typename T>
+	class CacheAlignedAllocator
+	{
+	public:
+		using value_type = T;
+
+		static constexpr std::align_val_t ALIGNMENT{ 64 };
+
+		CacheAlignedAllocator() noexcept = default;
+
+		template <typename U>
+		CacheAlignedAllocator(CacheAlignedAllocator<U> const&) noexcept {}
+
+		[[nodiscard]] T* allocate(size_t n)
+		{
+			return static_cast<T*>(::operator new(n * sizeof(T), ALIGNMENT));
+		}
+
+		void deallocate(T* ptr, size_t) noexcept
+		{
+			::operator delete(ptr, ALIGNMENT);
+		}
+
+		friend bool operator==(CacheAlignedAllocator const&, CacheAlignedAllocator const&) noexcept
+		{
+			return true;
+		}
+	};
+
+	// Read-only sorted map that stores its keys in Eytzinger (BFS) order: the children of node k are 2k and 2k + 1.
+	// The first levels of the implicit tree share a few cache lines that stay hot, and a lookup prefetches the
+	// block of 16-ish descendants four levels down while it compares, so at most sizes there is always a
+	// cache miss in flight instead of one miss per step like a binary search over a sorted vector.
+	// Built once from a stdext::flat_map; iteration visits the elements in storage order, not in key order.
+	template <typename Key, typename Mapped, typename Compare = std::less<Key>>
+	class EytzingerMap final
+	{
+	public:
+		using key_type = Key;
+		using mapped_type = Mapped;
+		using key_compare = Compare;
+		using size_type = size_t;
+
+		class const_iterator final
+		{
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = std::pair<Key, Mapped>;
+			using difference_type = ptrdiff_t;
+			using reference = std::pair<Key const&, Mapped const&>;
+
+			struct pointer final
+			{
+				reference ref;
+
+				reference const* operator->() const noexcept
+				{
+					return &ref;
+				}
+			};
+
+			const_iterator() noexcept = default;
+
+			[[nodiscard]] reference operator*() const noexcept
+			{
+				return { m_Map->m_Keys[m_Index], m_Map->m_Values[m_Index] };
+			}
+
+			[[nodiscard]] pointer operator->() const noexcept
+			{
+				return { **this };
+			}
+
+			const_iterator& operator++() noexcept
+			{
+				++m_Index;
+				return *this;
+			}
+
+			const_iterator operator++(int) noexcept
+			{
+				const_iterator const old{ *this };
+				++m_Index;
+				return old;
+			}
+
+			[[nodiscard]] bool operator==(const_iterator const& other) const noexcept = default;
+
+		private:
+			friend class EytzingerMap;
+
+			const_iterator(EytzingerMap const* map, size_t index) noexcept
+				: m_Map{ map }
+				, m_Index{ index }
+			{
+			}
+
+			EytzingerMap const* m_Map{ nullptr };
+			size_t m_Index{ 0 };
+		};
+		using iterator = const_iterator;
+
+		EytzingerMap() = default;
+
+		// Takes over the elements of the flat_map, which is left empty
+		template <typename KeyContainer, typename MappedContainer>
+		explicit EytzingerMap(stdext::flat_map<Key, Mapped, Compare, KeyContainer, MappedContainer>&& map)
+			: m_Compare{ map.key_comp() }
+		{
+			auto sorted{ std::move(map).extract() };
+
+			// Slot 0 is unused so the children of k are simply 2k and 2k + 1
+			m_Keys.resize(sorted.keys.size() + 1);
+			m_Values.resize(sorted.values.size() + 1);
+
+			size_t next{ 0 };
+			Build(sorted.keys, sorted.values, next, 1);
+		}
+
+		[[nodiscard]] const_iterator begin() const noexcept
+		{
+			return { this, 1 };
+		}
+
+		[[nodiscard]] const_iterator end() const noexcept
+		{
+			return { this, m_Keys.empty() ? 1 : m_Keys.size() };
+		}
+
+		[[nodiscard]] bool empty() const noexcept
+		{
+			return size() == 0;
+		}
+
+		[[nodiscard]] size_t size() const noexcept
+		{
+			return m_Keys.empty() ? 0 : m_Keys.size() - 1;
+		}
+
+		[[nodiscard]] const_iterator find(Key const& key) const noexcept
+		{
+			size_t const index{ LowerBoundIndex(key) };
+			if (index == 0 || m_Compare(key, m_Keys[index]))
+			{
+				return end();
+			}
+			return { this, index };
+		}
+
+		[[nodiscard]] bool contains(Key const& key) const noexcept
+		{
+			return find(key) != end();
+		}
+
+		[[nodiscard]] Mapped const& at(Key const& key) const
+		{
+			auto const it{ find(key) };
+			if (it == end())
+			{
+				throw std::out_of_range{ "EytzingerMap::at" };
+			}
+			return it->second;
+		}
+
+	private:
+		// Descendants of k four levels down (16k .. 16k + 15) share one cache line for 4 byte keys
+		static constexpr size_t PREFETCH_MULTIPLIER{ std::max<size_t>(1, 64 / sizeof(Key)) };
+
+		std::vector<Key, CacheAlignedAllocator<Key>> m_Keys;
+		std::vector<Mapped> m_Values;
+		[[no_unique_address]] Compare m_Compare{};
+
+		// In-order walk of the implicit tree, filling it with the sorted elements
+		template <typename KeyContainer, typename MappedContainer>
+		void Build(KeyContainer& keys, MappedContainer& values, size_t& next, size_t k)
+		{
+			if (k >= m_Keys.size())
+			{
+				return;
+			}
+
+			Build(keys, values, next, 2 * k);
+			m_Keys[k] = std::move(keys[next]);
+			m_Values[k] = std::move(values[next]);
+			++next;
+			Build(keys, values, next, 2 * k + 1);
+		}
+
+		static void Prefetch(void const* address) noexcept
+		{
+		#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+			_mm_prefetch(static_cast<char const*>(address), _MM_HINT_T0);
+		#elif defined(__GNUC__)
+			__builtin_prefetch(address);
+		#else
+			(void)address;
+		#endif
+		}
+
+		// Slot of the first key not less than key, 0 when there is none
+		[[nodiscard]] size_t LowerBoundIndex(Key const& key) const noexcept
+		{
+			size_t const n{ size() };
+			Key const* const keys{ m_Keys.data() };
+
+			size_t k{ 1 };
+			while (k <= n)
+			{
+				Prefetch(keys + std::min(k * PREFETCH_MULTIPLIER, n));
+				k = 2 * k + (m_Compare(keys[k], key) ? 1 : 0);
+			}
+
+			// Every right turn appended a 1 bit; the answer is where the last left turn was taken
+			return k >> (std::countr_one(k) + 1);
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,219 @@
+#ifndef MAU_PARALLEL_FLAT_MAP_H
+#define MAU_PARALLEL_FLAT_MAP_H
+
+#include <SG14/flat_map.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Mau
+{
+	// Calls func(0) .. func(workers - 1), each on its own thread (func(0) on the calling one), and waits for all of them
+	template <typename Func>
+	static void RunOnWorkers(size_t workers, Func const& func)
+	{
+		std::vector<std::jthread> threads;
+		threads.reserve(workers - 1);
+		for (size_t w{ 1 }; w < workers; ++w)
+		{
+			threads.emplace_back(func, w);
+		}
+		func(0);
+	}
+
+	// Builds a stdext::flat_map from unsorted (key, mapped) pairs with up to threads workers: every worker sorts and
+	// deduplicates one chunk of the input, then merges one key range of all chunks (split by splitters sampled from the
+	// sorted chunks) and finally moves its range into place. Same result as the range constructor and insert(first, last):
+	// of several equal keys the first one in the input is kept. Key and Mapped must be default constructible.
+	// Peak memory is two copies of the keys and values: the sorted chunks and the merged ranges, which take their memory
+	// from the map's allocators so a counting allocator sees all of it.
+	template <typename Map, typename RandomIt>
+	[[nodiscard]] static Map BuildFlatMapParallel(RandomIt first, RandomIt last, size_t threads, typename Map::key_compare const& compare = {})
+	{
+		using Key = typename Map::key_type;
+		using Compare = typename Map::key_compare;
+		using KeyContainer = typename Map::key_container_type;
+		using MappedContainer = typename Map::mapped_container_type;
+		static_assert(std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<RandomIt>::iterator_category>);
+
+		// Below this many elements per worker, starting the threads costs more than they save
+		constexpr size_t MIN_ELEMENTS_PER_WORKER{ 1 << 14 };
+		// Splitter candidates taken from every chunk, more of them balance the merge ranges better
+		constexpr size_t SAMPLES_PER_WORKER{ 64 };
+
+		size_t const n{ static_cast<size_t>(last - first) };
+		size_t const workers{ std::clamp<size_t>(threads, 1, std::max<size_t>(1, n / MIN_ELEMENTS_PER_WORKER)) };
+
+		KeyContainer keys(n);
+		MappedContainer values(n);
+
+		// Chunk w is [bounds[w], bounds[w + 1]), after deduplication its first lengths[w] elements are used
+		std::vector<size_t> bounds(workers + 1);
+		for (size_t w{ 0 }; w <= workers; ++w)
+		{
+			bounds[w] = n * w / workers;
+		}
+		std::vector<size_t> lengths(workers);
+
+		RunOnWorkers(workers, [&](size_t w)
+		{
+			size_t const begin{ bounds[w] };
+			size_t const end{ bounds[w + 1] };
+			for (size_t i{ begin }; i < end; ++i)
+			{
+				keys[i] = first[i].first;
+				values[i] = first[i].second;
+			}
+
+			// Stable, so within a chunk the first of several equal keys is the one that came first in the input
+			Compare less{ compare };
+			stdext::flatmap_detail::stable_sort_together(keys, values, begin, end, less);
+
+			auto const uniqueEnd{ stdext::flatmap_detail::unique_first_helper(keys.begin() + begin, keys.begin() + end, values.begin() + begin, less) };
+			lengths[w] = static_cast<size_t>(uniqueEnd - (keys.begin() + begin));
+		});
+
+		if (workers == 1)
+		{
+			keys.resize(lengths[0]);
+			values.resize(lengths[0]);
+
+			Map map{ compare };
+			map.replace(std::move(keys), std::move(values));
+			return map;
+		}
+
+		std::vector<Key> samples;
+		samples.reserve(workers * SAMPLES_PER_WORKER);
+		for (size_t w{ 0 }; w < workers; ++w)
+		{
+			for (size_t s{ 1 }; s <= SAMPLES_PER_WORKER && lengths[w] > 0; ++s)
+			{
+				samples.emplace_back(keys[bounds[w] + lengths[w] * s / (SAMPLES_PER_WORKER + 1)]);
+			}
+		}
+		std::sort(samples.begin(), samples.end(), std::ref(compare));
+
+		// Range b holds the keys in [splitters[b - 1], splitters[b])
+		std::vector<Key> splitters(workers - 1);
+		for (size_t b{ 1 }; b < workers; ++b)
+		{
+			splitters[b - 1] = samples[samples.size() * b / workers];
+		}
+
+		// Start of range b within chunk w is cuts[w * (workers + 1) + b], its end the start of range b + 1
+		std::vector<size_t> cuts(workers * (workers + 1));
+		RunOnWorkers(workers, [&](size_t w)
+		{
+			auto const chunkBegin{ keys.begin() + bounds[w] };
+			auto const chunkEnd{ chunkBegin + lengths[w] };
+
+			size_t* const chunkCuts{ cuts.data() + w * (workers + 1) };
+			chunkCuts[0] = bounds[w];
+			chunkCuts[workers] = bounds[w] + lengths[w];
+			for (size_t b{ 1 }; b < workers; ++b)
+			{
+				chunkCuts[b] = static_cast<size_t>(std::lower_bound(chunkBegin, chunkEnd, splitters[b - 1], std::ref(compare)) - keys.begin());
+			}
+		});
+
+		// Worker b merges range b of every chunk. Equal keys always fall in the same range, duplicates across chunks are dropped
+		// here and the one from the earliest chunk is kept.
+		std::vector<KeyContainer> rangeKeys;
+		std::vector<MappedContainer> rangeValues;
+		rangeKeys.reserve(workers);
+		rangeValues.reserve(workers);
+		for (size_t b{ 0 }; b < workers; ++b)
+		{
+			rangeKeys.emplace_back(keys.get_allocator());
+			rangeValues.emplace_back(values.get_allocator());
+		}
+
+		RunOnWorkers(workers, [&](size_t b)
+		{
+			Compare less{ compare };
+
+			std::vector<size_t> next(workers);
+			std::vector<size_t> end(workers);
+			size_t total{ 0 };
+			for (size_t w{ 0 }; w < workers; ++w)
+			{
+				next[w] = cuts[w * (workers + 1) + b];
+				end[w] = cuts[w * (workers + 1) + b + 1];
+				total += end[w] - next[w];
+			}
+
+			KeyContainer& outKeys{ rangeKeys[b] };
+			MappedContainer& outValues{ rangeValues[b] };
+			outKeys.reserve(total);
+			outValues.reserve(total);
+
+			// Heap of the chunks that still have elements in this range, the one with the smallest head key on top,
+			// so picking every element costs O(log workers). Equal heads come out in chunk order.
+			auto const after{ [&](size_t a, size_t b)
+			{
+				return less(keys[next[b]], keys[next[a]]) || (!less(keys[next[a]], keys[next[b]]) && b < a);
+			} };
+
+			std::vector<size_t> heap;
+			heap.reserve(workers);
+			for (size_t w{ 0 }; w < workers; ++w)
+			{
+				if (next[w] != end[w])
+				{
+					heap.emplace_back(w);
+				}
+			}
+			std::make_heap(heap.begin(), heap.end(), after);
+
+			while (!heap.empty())
+			{
+				std::pop_heap(heap.begin(), heap.end(), after);
+				size_t const w{ heap.back() };
+
+				size_t const i{ next[w]++ };
+				if (outKeys.empty() || less(outKeys.back(), keys[i]))
+				{
+					outKeys.emplace_back(std::move(keys[i]));
+					outValues.emplace_back(std::move(values[i]));
+				}
+
+				if (next[w] == end[w])
+				{
+					heap.pop_back();
+				}
+				else
+				{
+					std::push_heap(heap.begin(), heap.end(), after);
+				}
+			}
+		});
+
+		std::vector<size_t> offsets(workers + 1, 0);
+		for (size_t b{ 0 }; b < workers; ++b)
+		{
+			offsets[b + 1] = offsets[b] + rangeKeys[b].size();
+		}
+
+		// Shrinking keeps the allocation, every range is moved to its final place in parallel
+		keys.resize(offsets[workers]);
+		values.resize(offsets[workers]);
+		RunOnWorkers(workers, [&](size_t b)
+		{
+			std::move(rangeKeys[b].begin(), rangeKeys[b].end(), keys.begin() + offsets[b]);
+			std::move(rangeValues[b].begin(), rangeValues[b].end(), values.begin() + offsets[b]);
+		});
+
+		Map map{ compare };
+		map.replace(std::move(keys), std::move(values));
+		return map;
+	}
+}
+
+#endif
@@ -0,0 +1,583 @@
+#ifndef MAU_ROBIN_HOOD_MAP_H
+#define MAU_ROBIN_HOOD_MAP_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(_MSC_VER) && defined(_M_X64) && !defined(__SIZEOF_INT128__)
+#	include <intrin.h>
+#endif
+
+namespace Mau
+{
+	// Linear probing hash map with Robin Hood insertion: an element that is further from its home slot than the
+	// resident of a slot takes that slot, and the resident moves on. Probe distances stay close to the mean instead
+	// of a few keys paying for long clusters, and a lookup can stop as soon as it meets an element closer to home
+	// than it would be itself. Every slot stores its element's probe distance. Erase shifts the following elements
+	// of the cluster back by one, so there are no tombstones and distances never degrade with churn.
+	// The table does not wrap around: a tail of extra slots behind the last home slot holds the overflow, and a
+	// probe reaching its end or the maximum distance grows the table. Key and Mapped must be default constructible.
+	template <typename Key, typename Mapped, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+	class RobinHoodMap final
+	{
+		struct Slot final
+		{
+			Key key{};
+			Mapped value{};
+			// Distance from the home slot plus one, 0 for an empty slot
+			uint8_t distance{ 0 };
+		};
+
+	public:
+		using key_type = Key;
+		using mapped_type = Mapped;
+		using value_type = std::pair<Key, Mapped>;
+		using hasher = Hash;
+		using key_equal = KeyEqual;
+		using size_type = size_t;
+
+		template <bool Const>
+		class Iterator final
+		{
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = std::pair<Key, Mapped>;
+			using difference_type = ptrdiff_t;
+			using reference = std::pair<Key const&, std::conditional_t<Const, Mapped const&, Mapped&>>;
+
+			struct pointer final
+			{
+				reference ref;
+
+				reference const* operator->() const noexcept
+				{
+					return &ref;
+				}
+			};
+
+			Iterator() noexcept = default;
+
+			// iterator converts to const_iterator
+			template <bool OtherConst, typename = std::enable_if_t<Const && !OtherConst>>
+			Iterator(Iterator<OtherConst> const& other) noexcept
+				: m_Slot{ other.m_Slot }
+				, m_End{ other.m_End }
+			{
+			}
+
+			[[nodiscard]] reference operator*() const noexcept
+			{
+				return { m_Slot->key, m_Slot->value };
+			}
+
+			[[nodiscard]] pointer operator->() const noexcept
+			{
+				return { **this };
+			}
+
+			Iterator& operator++() noexcept
+			{
+				++m_Slot;
+				SkipEmpty();
+				return *this;
+			}
+
+			Iterator operator++(int) noexcept
+			{
+				Iterator const old{ *this };
+				++*this;
+				return old;
+			}
+
+			[[nodiscard]] bool operator==(Iterator const& other) const noexcept
+			{
+				return m_Slot == other.m_Slot;
+			}
+
+		private:
+			friend class RobinHoodMap;
+			template <bool>
+			friend class Iterator;
+
+			using SlotPointer = std::conditional_t<Const, Slot const*, Slot*>;
+
+			Iterator(SlotPointer slot, SlotPointer end) noexcept
+				: m_Slot{ slot }
+				, m_End{ end }
+			{
+			}
+
+			void SkipEmpty() noexcept
+			{
+				while (m_Slot != m_End && m_Slot->distance == 0)
+				{
+					++m_Slot;
+				}
+			}
+
+			SlotPointer m_Slot{ nullptr };
+			SlotPointer m_End{ nullptr };
+		};
+		using iterator = Iterator<false>;
+		using const_iterator = Iterator<true>;
+
+		RobinHoodMap() = default;
+
+		explicit RobinHoodMap(size_t bucketCount, Hash const& hash = {}, KeyEqual const& equal = {})
+			: m_Hash{ hash }
+			, m_Equal{ equal }
+		{
+			rehash(bucketCount);
+		}
+
+		RobinHoodMap(RobinHoodMap const&) = default;
+		RobinHoodMap& operator=(RobinHoodMap const&) = default;
+
+		// Leaves other empty, a moved-from vector alone would not reset the size
+		RobinHoodMap(RobinHoodMap&& other) noexcept
+		{
+			swap(other);
+		}
+
+		RobinHoodMap& operator=(RobinHoodMap&& other) noexcept
+		{
+			RobinHoodMap moved{ std::move(other) };
+			swap(moved);
+			return *this;
+		}
+
+		~RobinHoodMap() = default;
+
+		[[nodiscard]] iterator begin() noexcept
+		{
+			iterator it{ m_Slots.data(), m_Slots.data() + m_Slots.size() };
+			it.SkipEmpty();
+			return it;
+		}
+
+		[[nodiscard]] const_iterator begin() const noexcept
+		{
+			const_iterator it{ m_Slots.data(), m_Slots.data() + m_Slots.size() };
+			it.SkipEmpty();
+			return it;
+		}
+
+		[[nodiscard]] iterator end() noexcept
+		{
+			return IteratorAt(m_Slots.size());
+		}
+
+		[[nodiscard]] const_iterator end() const noexcept
+		{
+			return IteratorAt(m_Slots.size());
+		}
+
+		[[nodiscard]] bool empty() const noexcept
+		{
+			return m_Size == 0;
+		}
+
+		[[nodiscard]] size_t size() const noexcept
+		{
+			return m_Size;
+		}
+
+		// Home slots; the overflow tail behind them is not counted
+		[[nodiscard]] size_t bucket_count() const noexcept
+		{
+			return m_BucketCount;
+		}
+
+		[[nodiscard]] float load_factor() const noexcept
+		{
+			return m_BucketCount == 0 ? 0.0f : static_cast<float>(m_Size) / static_cast<float>(m_BucketCount);
+		}
+
+		[[nodiscard]] float max_load_factor() const noexcept
+		{
+			return m_MaxLoadFactor;
+		}
+
+		// Robin Hood keeps probes short up to high loads, 0.95 still has a mean successful probe of a few slots
+		void max_load_factor(float loadFactor) noexcept
+		{
+			m_MaxLoadFactor = std::clamp(loadFactor, 0.1f, 0.99f);
+		}
+
+		// Exactly bucketCount home slots (no rounding to a power of two), at least enough for size() at the max load factor
+		void rehash(size_t bucketCount)
+		{
+			size_t const minimum{ static_cast<size_t>(std::ceil(static_cast<double>(m_Size) / m_MaxLoadFactor)) };
+			Rehash(std::max({ bucketCount, minimum, MIN_BUCKET_COUNT }));
+		}
+
+		void reserve(size_t count)
+		{
+			if (count > MaxSizeFor(m_BucketCount))
+			{
+				rehash(static_cast<size_t>(std::ceil(static_cast<double>(count) / m_MaxLoadFactor)));
+			}
+		}
+
+		template <typename... Args>
+		std::pair<iterator, bool> try_emplace(Key const& key, Args&&... args)
+		{
+			return TryEmplace(key, std::forward<Args>(args)...);
+		}
+
+		template <typename... Args>
+		std::pair<iterator, bool> try_emplace(Key&& key, Args&&... args)
+		{
+			return TryEmplace(std::move(key), std::forward<Args>(args)...);
+		}
+
+		template <typename K, typename M>
+		std::pair<iterator, bool> emplace(K&& key, M&& mapped)
+		{
+			return TryEmplace(Key(std::forward<K>(key)), std::forward<M>(mapped));
+		}
+
+		std::pair<iterator, bool> insert(std::pair<Key, Mapped> const& value)
+		{
+			return TryEmplace(value.first, value.second);
+		}
+
+		Mapped& operator[](Key const& key)
+		{
+			return TryEmplace(key).first->second;
+		}
+
+		[[nodiscard]] iterator find(Key const& key)
+		{
+			return IteratorAt(FindIndex(key));
+		}
+
+		[[nodiscard]] const_iterator find(Key const& key) const
+		{
+			return IteratorAt(FindIndex(key));
+		}
+
+		[[nodiscard]] bool contains(Key const& key) const
+		{
+			return FindIndex(key) != m_Slots.size();
+		}
+
+		[[nodiscard]] size_t count(Key const& key) const
+		{
+			return contains(key) ? 1 : 0;
+		}
+
+		[[nodiscard]] Mapped& at(Key const& key)
+		{
+			size_t const index{ FindIndex(key) };
+			if (index == m_Slots.size())
+			{
+				throw std::out_of_range{ "RobinHoodMap::at" };
+			}
+			return m_Slots[index].value;
+		}
+
+		[[nodiscard]] Mapped const& at(Key const& key) const
+		{
+			size_t const index{ FindIndex(key) };
+			if (index == m_Slots.size())
+			{
+				throw std::out_of_range{ "RobinHoodMap::at" };
+			}
+			return m_Slots[index].value;
+		}
+
+		size_t erase(Key const& key)
+		{
+			size_t const index{ FindIndex(key) };
+			if (index == m_Slots.size())
+			{
+				return 0;
+			}
+			EraseAt(index);
+			return 1;
+		}
+
+		// The shift only moves elements that come after position, so erasing while iterating visits every element once
+		iterator erase(const_iterator position)
+		{
+			size_t const index{ static_cast<size_t>(position.m_Slot - m_Slots.data()) };
+			EraseAt(index);
+
+			iterator next{ IteratorAt(index) };
+			next.SkipEmpty();
+			return next;
+		}
+
+		void clear() noexcept
+		{
+			for (Slot& slot : m_Slots)
+			{
+				slot = Slot{};
+			}
+			m_Size = 0;
+		}
+
+		void swap(RobinHoodMap& other) noexcept
+		{
+			using std::swap;
+			swap(m_Slots, other.m_Slots);
+			swap(m_BucketCount, other.m_BucketCount);
+			swap(m_Size, other.m_Size);
+			swap(m_MaxLoadFactor, other.m_MaxLoadFactor);
+			swap(m_Hash, other.m_Hash);
+			swap(m_Equal, other.m_Equal);
+		}
+
+		// Number of elements per probe length, index 0 holds the ones in their home slot.
+		// A successful lookup of such an element reads index + 1 slots.
+		[[nodiscard]] std::vector<size_t> probe_histogram() const
+		{
+			std::vector<size_t> histogram;
+			for (Slot const& slot : m_Slots)
+			{
+				if (slot.distance == 0)
+				{
+					continue;
+				}
+				if (slot.distance > histogram.size())
+				{
+					histogram.resize(slot.distance, 0);
+				}
+				++histogram[slot.distance - 1];
+			}
+			return histogram;
+		}
+
+	private:
+		static constexpr size_t MIN_BUCKET_COUNT{ 16 };
+		// Largest distance a slot can store; an insert that would need more grows the table
+		static constexpr uint32_t MAX_DISTANCE{ 255 };
+
+		std::vector<Slot> m_Slots;
+		size_t m_BucketCount{ 0 };
+		size_t m_Size{ 0 };
+		float m_MaxLoadFactor{ 0.875f };
+		[[no_unique_address]] Hash m_Hash{};
+		[[no_unique_address]] KeyEqual m_Equal{};
+
+		// Rounded, 0.95f is slightly below 0.95 and 100000 buckets should still hold 95000 elements
+		[[nodiscard]] size_t MaxSizeFor(size_t bucketCount) const noexcept
+		{
+			return static_cast<size_t>(std::llround(static_cast<double>(bucketCount) * m_MaxLoadFactor));
+		}
+
+		// Small tables get as many tail slots as home slots, so they can never run out of it before they grow
+		[[nodiscard]] static size_t TailFor(size_t bucketCount) noexcept
+		{
+			return std::min<size_t>(bucketCount, MAX_DISTANCE);
+		}
+
+		// Fibonacci hashing spreads hashes like std::hash<int>'s identity into the high bits, and the high
+		// half of the product with the bucket count maps them to [0, bucketCount) without a division
+		[[nodiscard]] size_t Home(Key const& key, size_t bucketCount) const noexcept
+		{
+			uint64_t const hash{ static_cast<uint64_t>(m_Hash(key)) * 0x9E3779B97F4A7C15ull };
+		#if defined(__SIZEOF_INT128__)
+			return static_cast<size_t>((static_cast<unsigned __int128>(hash) * bucketCount) >> 64);
+		#elif defined(_MSC_VER) && defined(_M_X64)
+			uint64_t high{};
+			_umul128(hash, bucketCount, &high);
+			return static_cast<size_t>(high);
+		#else
+			return static_cast<size_t>(((hash >> 32) * bucketCount) >> 32);
+		#endif
+		}
+
+		[[nodiscard]] size_t Home(Key const& key) const noexcept
+		{
+			return Home(key, m_BucketCount);
+		}
+
+		[[nodiscard]] iterator IteratorAt(size_t index) noexcept
+		{
+			return { m_Slots.data() + index, m_Slots.data() + m_Slots.size() };
+		}
+
+		[[nodiscard]] const_iterator IteratorAt(size_t index) const noexcept
+		{
+			return { m_Slots.data() + index, m_Slots.data() + m_Slots.size() };
+		}
+
+		// Slot holding key, m_Slots.size() when there is none
+		[[nodiscard]] size_t FindIndex(Key const& key) const
+		{
+			if (m_Size == 0)
+			{
+				return m_Slots.size();
+			}
+
+			// Only an element with the same home slot, and so the same distance, can hold key. Meeting a slot
+			// with a smaller distance (or an empty one) means key would have displaced it.
+			size_t index{ Home(key) };
+			for (uint32_t distance{ 1 };; ++distance, ++index)
+			{
+				Slot const& slot{ m_Slots[index] };
+				if (slot.distance < distance)
+				{
+					return m_Slots.size();
+				}
+				if (slot.distance == distance && m_Equal(slot.key, key))
+				{
+					return index;
+				}
+			}
+		}
+
+		// Where an element with the given home slot goes in slots: the first slot whose element is closer to its home
+		// than the new one would be. The elements from there up to the next empty slot move one slot further. Fails
+		// when a distance would overflow or the probe would run past the tail. Only the distances are read.
+		[[nodiscard]] static bool FindInsertPosition(std::vector<Slot> const& slots, size_t home, size_t& position, uint32_t& distance, size_t& empty) noexcept
+		{
+			position = home;
+			distance = 1;
+			while (slots[position].distance >= distance)
+			{
+				++position;
+				++distance;
+			}
+			if (distance > MAX_DISTANCE)
+			{
+				return false;
+			}
+
+			// The last slot always stays empty, so every probe ends inside the table
+			for (empty = position;; ++empty)
+			{
+				if (empty + 1 == slots.size() || slots[empty].distance == MAX_DISTANCE)
+				{
+					return false;
+				}
+				if (slots[empty].distance == 0)
+				{
+					return true;
+				}
+			}
+		}
+
+		// Moves [position, empty) one slot up and puts key and value at position
+		void InsertAt(size_t position, uint32_t distance, size_t empty, Key&& key, Mapped&& value) noexcept
+		{
+			for (size_t i{ empty }; i != position; --i)
+			{
+				m_Slots[i].key = std::move(m_Slots[i - 1].key);
+				m_Slots[i].value = std::move(m_Slots[i - 1].value);
+				m_Slots[i].distance = static_cast<uint8_t>(m_Slots[i - 1].distance + 1);
+			}
+			m_Slots[position].key = std::move(key);
+			m_Slots[position].value = std::move(value);
+			m_Slots[position].distance = static_cast<uint8_t>(distance);
+		}
+
+		template <typename K, typename... Args>
+		std::pair<iterator, bool> TryEmplace(K&& key, Args&&... args)
+		{
+			if (m_Size != 0)
+			{
+				size_t const found{ FindIndex(key) };
+				if (found != m_Slots.size())
+				{
+					return { IteratorAt(found), false };
+				}
+			}
+
+			if (m_Size + 1 > MaxSizeFor(m_BucketCount))
+			{
+				Rehash(std::max(MIN_BUCKET_COUNT, m_BucketCount * 2));
+			}
+
+			size_t position{};
+			uint32_t distance{};
+			size_t empty{};
+			if (!FindInsertPosition(m_Slots, Home(key), position, distance, empty))
+			{
+				// At half the load a probe that long is practically impossible unless the hash maps many keys to one slot
+				Rehash(m_BucketCount * 2);
+				if (!FindInsertPosition(m_Slots, Home(key), position, distance, empty))
+				{
+					throw std::overflow_error{ "RobinHoodMap: probe distance overflow, the hash clusters too many keys" };
+				}
+			}
+
+			// Built before anything moves, a throwing constructor leaves the map unchanged
+			Key newKey(std::forward<K>(key));
+			Mapped newValue(std::forward<Args>(args)...);
+			InsertAt(position, distance, empty, std::move(newKey), std::move(newValue));
+			++m_Size;
+			return { IteratorAt(position), true };
+		}
+
+		// Backward shift: the following elements that are not in their home slot move one slot closer to it
+		void EraseAt(size_t index) noexcept
+		{
+			size_t next{ index + 1 };
+			while (next != m_Slots.size() && m_Slots[next].distance > 1)
+			{
+				m_Slots[index].key = std::move(m_Slots[next].key);
+				m_Slots[index].value = std::move(m_Slots[next].value);
+				m_Slots[index].distance = static_cast<uint8_t>(m_Slots[next].distance - 1);
+				index = next++;
+			}
+			m_Slots[index] = Slot{};
+			--m_Size;
+		}
+
+		// Every element's slot in the new table is found before anything moves. A hash so poor that even the larger
+		// table overflows a distance cannot be fixed by growing, the error is reported and the map is left unchanged.
+		void Rehash(size_t bucketCount)
+		{
+			std::vector<Slot> slots(bucketCount + TailFor(bucketCount));
+			// Old slot of the element that goes to each new slot, shifted along with the distances
+			std::vector<size_t> origins(slots.size());
+
+			for (size_t from{ 0 }; from != m_Slots.size(); ++from)
+			{
+				if (m_Slots[from].distance == 0)
+				{
+					continue;
+				}
+
+				size_t position{};
+				uint32_t distance{};
+				size_t empty{};
+				if (!FindInsertPosition(slots, Home(m_Slots[from].key, bucketCount), position, distance, empty))
+				{
+					throw std::overflow_error{ "RobinHoodMap: probe distance overflow, the hash clusters too many keys" };
+				}
+				for (size_t i{ empty }; i != position; --i)
+				{
+					slots[i].distance = static_cast<uint8_t>(slots[i - 1].distance + 1);
+					origins[i] = origins[i - 1];
+				}
+				slots[position].distance = static_cast<uint8_t>(distance);
+				origins[position] = from;
+			}
+
+			for (size_t i{ 0 }; i != slots.size(); ++i)
+			{
+				if (slots[i].distance != 0)
+				{
+					slots[i].key = std::move(m_Slots[origins[i]].key);
+					slots[i].value = std::move(m_Slots[origins[i]].value);
+				}
+			}
+			m_Slots.swap(slots);
+			m_BucketCount = bucketCount;
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,274 @@
+#ifndef MAU_SLOT_MAP_H
+#define MAU_SLOT_MAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace Mau
+{
+	// Refers to one element of a SlotMap. The generation tells the element apart from later ones stored in the same slot.
+	struct SlotMapHandle final
+	{
+		uint32_t index{ std::numeric_limits<uint32_t>::max() };
+		uint32_t generation{ 0 };
+
+		[[nodiscard]] bool operator==(SlotMapHandle const&) const noexcept = default;
+	};
+
+	// Unordered container that hands out a handle per inserted element. The values are packed in one dense array, so
+	// iterating is a plain vector walk, and every handle names a slot that points into it. Erasing moves the last value
+	// into the gap and repoints its slot, so handles stay valid while values move. A freed slot is reused with the next
+	// generation, so handles to erased elements stop matching. Generations are odd while a slot is in use; a slot
+	// reused 2^31 times wraps around and could match a handle that old again.
+	template <typename T>
+	class SlotMap final
+	{
+	public:
+		using value_type = T;
+		using handle_type = SlotMapHandle;
+		using size_type = size_t;
+		using iterator = typename std::vector<T>::iterator;
+		using const_iterator = typename std::vector<T>::const_iterator;
+
+		SlotMap() = default;
+
+		SlotMap(SlotMap const&) = default;
+		SlotMap& operator=(SlotMap const&) = default;
+
+		// Leaves other empty, moved-from vectors alone would leave a dangling free list head
+		SlotMap(SlotMap&& other) noexcept
+		{
+			swap(other);
+		}
+
+		SlotMap& operator=(SlotMap&& other) noexcept
+		{
+			SlotMap moved{ std::move(other) };
+			swap(moved);
+			return *this;
+		}
+
+		~SlotMap() = default;
+
+		// Dense order, which changes on every erase
+		[[nodiscard]] iterator begin() noexcept
+		{
+			return m_Values.begin();
+		}
+
+		[[nodiscard]] const_iterator begin() const noexcept
+		{
+			return m_Values.begin();
+		}
+
+		[[nodiscard]] iterator end() noexcept
+		{
+			return m_Values.end();
+		}
+
+		[[nodiscard]] const_iterator end() const noexcept
+		{
+			return m_Values.end();
+		}
+
+		[[nodiscard]] bool empty() const noexcept
+		{
+			return m_Values.empty();
+		}
+
+		[[nodiscard]] size_t size() const noexcept
+		{
+			return m_Values.size();
+		}
+
+		void reserve(size_t count)
+		{
+			m_Values.reserve(count);
+			m_DenseToSlot.reserve(count);
+			m_Slots.reserve(count);
+		}
+
+		template <typename... Args>
+		handle_type emplace(Args&&... args)
+		{
+			if (m_Values.size() == NONE)
+			{
+				throw std::length_error{ "SlotMap: too many elements" };
+			}
+
+			if (m_FreeHead == NONE)
+			{
+				m_Slots.push_back(Slot{ NONE, 0 });
+				m_FreeHead = static_cast<uint32_t>(m_Slots.size() - 1);
+			}
+
+			// Nothing is taken off the free list before the value exists, a throwing constructor leaves the map unchanged
+			m_DenseToSlot.push_back(m_FreeHead);
+			try
+			{
+				m_Values.emplace_back(std::forward<Args>(args)...);
+			}
+			catch (...)
+			{
+				m_DenseToSlot.pop_back();
+				throw;
+			}
+
+			uint32_t const index{ m_FreeHead };
+			Slot& slot{ m_Slots[index] };
+			m_FreeHead = slot.dense;
+			slot.dense = static_cast<uint32_t>(m_Values.size() - 1);
+			++slot.generation;
+			return { index, slot.generation };
+		}
+
+		handle_type insert(T const& value)
+		{
+			return emplace(value);
+		}
+
+		handle_type insert(T&& value)
+		{
+			return emplace(std::move(value));
+		}
+
+		[[nodiscard]] iterator find(handle_type handle) noexcept
+		{
+			Slot const* const slot{ FindSlot(handle) };
+			return slot == nullptr ? end() : begin() + slot->dense;
+		}
+
+		[[nodiscard]] const_iterator find(handle_type handle) const noexcept
+		{
+			Slot const* const slot{ FindSlot(handle) };
+			return slot == nullptr ? end() : begin() + slot->dense;
+		}
+
+		[[nodiscard]] bool contains(handle_type handle) const noexcept
+		{
+			return FindSlot(handle) != nullptr;
+		}
+
+		[[nodiscard]] T& at(handle_type handle)
+		{
+			Slot const* const slot{ FindSlot(handle) };
+			if (slot == nullptr)
+			{
+				throw std::out_of_range{ "SlotMap::at" };
+			}
+			return m_Values[slot->dense];
+		}
+
+		[[nodiscard]] T const& at(handle_type handle) const
+		{
+			Slot const* const slot{ FindSlot(handle) };
+			if (slot == nullptr)
+			{
+				throw std::out_of_range{ "SlotMap::at" };
+			}
+			return m_Values[slot->dense];
+		}
+
+		// Handle of the element at a dense position, for walking values and handles together
+		[[nodiscard]] handle_type handle_of(const_iterator position) const noexcept
+		{
+			uint32_t const index{ m_DenseToSlot[static_cast<size_t>(position - begin())] };
+			return { index, m_Slots[index].generation };
+		}
+
+		size_t erase(handle_type handle)
+		{
+			Slot const* const slot{ FindSlot(handle) };
+			if (slot == nullptr)
+			{
+				return 0;
+			}
+			EraseAt(slot->dense);
+			return 1;
+		}
+
+		// The last element moves into position, so erasing while iterating continues at the returned iterator
+		iterator erase(const_iterator position)
+		{
+			size_t const dense{ static_cast<size_t>(position - begin()) };
+			EraseAt(dense);
+			return begin() + static_cast<ptrdiff_t>(dense);
+		}
+
+		void clear() noexcept
+		{
+			for (uint32_t const index : m_DenseToSlot)
+			{
+				Release(index);
+			}
+			m_Values.clear();
+			m_DenseToSlot.clear();
+		}
+
+		void swap(SlotMap& other) noexcept
+		{
+			using std::swap;
+			swap(m_Values, other.m_Values);
+			swap(m_DenseToSlot, other.m_DenseToSlot);
+			swap(m_Slots, other.m_Slots);
+			swap(m_FreeHead, other.m_FreeHead);
+		}
+
+	private:
+		static constexpr uint32_t NONE{ std::numeric_limits<uint32_t>::max() };
+
+		// In use: dense is the position of the value. Free: dense is the next free slot.
+		struct Slot final
+		{
+			uint32_t dense;
+			uint32_t generation;
+		};
+
+		std::vector<T> m_Values;
+		// Slot of every value, to repoint it when the value moves
+		std::vector<uint32_t> m_DenseToSlot;
+		std::vector<Slot> m_Slots;
+		// Most recently freed slot first, it is the most likely one to still be cached
+		uint32_t m_FreeHead{ NONE };
+
+		[[nodiscard]] Slot const* FindSlot(handle_type handle) const noexcept
+		{
+			if (handle.index >= m_Slots.size())
+			{
+				return nullptr;
+			}
+
+			Slot const& slot{ m_Slots[handle.index] };
+			return (slot.generation == handle.generation && (slot.generation & 1) != 0) ? &slot : nullptr;
+		}
+
+		void EraseAt(size_t dense)
+		{
+			uint32_t const index{ m_DenseToSlot[dense] };
+			size_t const last{ m_Values.size() - 1 };
+			if (dense != last)
+			{
+				m_Values[dense] = std::move(m_Values[last]);
+				m_DenseToSlot[dense] = m_DenseToSlot[last];
+				m_Slots[m_DenseToSlot[dense]].dense = static_cast<uint32_t>(dense);
+			}
+			m_Values.pop_back();
+			m_DenseToSlot.pop_back();
+			Release(index);
+		}
+
+		void Release(uint32_t index) noexcept
+		{
+			Slot& slot{ m_Slots[index] };
+			++slot.generation;
+			slot.dense = m_FreeHead;
+			m_FreeHead = index;
+		}
+	};
+}
+
+#endif
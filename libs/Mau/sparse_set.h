@@ -0,0 +1,225 @@
+#ifndef MAU_SPARSE_SET_H
+#define MAU_SPARSE_SET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace Mau
+{
+	// Values keyed by a caller chosen 32 bit id, like the components of an entity. The values and their ids are packed
+	// in two dense arrays, and a sparse array indexed by id holds every value's dense position. The sparse array is
+	// split in pages of PageSize entries that are only allocated once an id on them is used, so scattered ids cost a page
+	// directory entry per PageSize ids instead of an entry per id. Lookup, insert and erase are O(1); erasing moves the
+	// last value into the gap, so the dense order changes but an id keeps naming the same value.
+	template <typename T, size_t PageSize = 4096>
+	class SparseSet final
+	{
+		static_assert(PageSize != 0 && (PageSize & (PageSize - 1)) == 0, "SparseSet pages are a power of two in size");
+
+	public:
+		using key_type = uint32_t;
+		using value_type = T;
+		using size_type = size_t;
+		using iterator = typename std::vector<T>::iterator;
+		using const_iterator = typename std::vector<T>::const_iterator;
+
+		// Dense order, which changes on every erase
+		[[nodiscard]] iterator begin() noexcept
+		{
+			return m_Values.begin();
+		}
+
+		[[nodiscard]] const_iterator begin() const noexcept
+		{
+			return m_Values.begin();
+		}
+
+		[[nodiscard]] iterator end() noexcept
+		{
+			return m_Values.end();
+		}
+
+		[[nodiscard]] const_iterator end() const noexcept
+		{
+			return m_Values.end();
+		}
+
+		// The id of every value, in the same order
+		[[nodiscard]] std::span<uint32_t const> ids() const noexcept
+		{
+			return m_Ids;
+		}
+
+		[[nodiscard]] bool empty() const noexcept
+		{
+			return m_Values.empty();
+		}
+
+		[[nodiscard]] size_t size() const noexcept
+		{
+			return m_Values.size();
+		}
+
+		// Dense storage only, sparse pages are allocated by the ids that get used
+		void reserve(size_t count)
+		{
+			m_Ids.reserve(count);
+			m_Values.reserve(count);
+		}
+
+		template <typename... Args>
+		std::pair<iterator, bool> try_emplace(uint32_t id, Args&&... args)
+		{
+			uint32_t& entry{ SparseEntry(id) };
+			if (entry != NONE)
+			{
+				return { begin() + entry, false };
+			}
+			if (m_Values.size() == NONE)
+			{
+				throw std::length_error{ "SparseSet: too many elements" };
+			}
+
+			m_Ids.push_back(id);
+			try
+			{
+				m_Values.emplace_back(std::forward<Args>(args)...);
+			}
+			catch (...)
+			{
+				m_Ids.pop_back();
+				throw;
+			}
+
+			entry = static_cast<uint32_t>(m_Values.size() - 1);
+			return { begin() + entry, true };
+		}
+
+		template <typename V>
+		std::pair<iterator, bool> emplace(uint32_t id, V&& value)
+		{
+			return try_emplace(id, std::forward<V>(value));
+		}
+
+		[[nodiscard]] iterator find(uint32_t id) noexcept
+		{
+			uint32_t const dense{ DenseIndex(id) };
+			return dense == NONE ? end() : begin() + dense;
+		}
+
+		[[nodiscard]] const_iterator find(uint32_t id) const noexcept
+		{
+			uint32_t const dense{ DenseIndex(id) };
+			return dense == NONE ? end() : begin() + dense;
+		}
+
+		[[nodiscard]] bool contains(uint32_t id) const noexcept
+		{
+			return DenseIndex(id) != NONE;
+		}
+
+		[[nodiscard]] size_t count(uint32_t id) const noexcept
+		{
+			return contains(id) ? 1 : 0;
+		}
+
+		[[nodiscard]] T& at(uint32_t id)
+		{
+			uint32_t const dense{ DenseIndex(id) };
+			if (dense == NONE)
+			{
+				throw std::out_of_range{ "SparseSet::at" };
+			}
+			return m_Values[dense];
+		}
+
+		[[nodiscard]] T const& at(uint32_t id) const
+		{
+			uint32_t const dense{ DenseIndex(id) };
+			if (dense == NONE)
+			{
+				throw std::out_of_range{ "SparseSet::at" };
+			}
+			return m_Values[dense];
+		}
+
+		size_t erase(uint32_t id)
+		{
+			uint32_t const dense{ DenseIndex(id) };
+			if (dense == NONE)
+			{
+				return 0;
+			}
+
+			size_t const last{ m_Values.size() - 1 };
+			if (dense != last)
+			{
+				m_Values[dense] = std::move(m_Values[last]);
+				m_Ids[dense] = m_Ids[last];
+				m_Pages[m_Ids[dense] / PageSize][m_Ids[dense] % PageSize] = dense;
+			}
+			m_Values.pop_back();
+			m_Ids.pop_back();
+			m_Pages[id / PageSize][id % PageSize] = NONE;
+			return 1;
+		}
+
+		// Keeps the sparse pages, they are reset entry by entry
+		void clear() noexcept
+		{
+			for (uint32_t const id : m_Ids)
+			{
+				m_Pages[id / PageSize][id % PageSize] = NONE;
+			}
+			m_Ids.clear();
+			m_Values.clear();
+		}
+
+		void swap(SparseSet& other) noexcept
+		{
+			using std::swap;
+			swap(m_Pages, other.m_Pages);
+			swap(m_Ids, other.m_Ids);
+			swap(m_Values, other.m_Values);
+		}
+
+	private:
+		static constexpr uint32_t NONE{ std::numeric_limits<uint32_t>::max() };
+
+		// Dense position per id, NONE for ids without a value. An empty page has never been used.
+		std::vector<std::vector<uint32_t>> m_Pages;
+		std::vector<uint32_t> m_Ids;
+		std::vector<T> m_Values;
+
+		[[nodiscard]] uint32_t DenseIndex(uint32_t id) const noexcept
+		{
+			size_t const page{ id / PageSize };
+			if (page >= m_Pages.size() || m_Pages[page].empty())
+			{
+				return NONE;
+			}
+			return m_Pages[page][id % PageSize];
+		}
+
+		[[nodiscard]] uint32_t& SparseEntry(uint32_t id)
+		{
+			size_t const page{ id / PageSize };
+			if (page >= m_Pages.size())
+			{
+				m_Pages.resize(page + 1);
+			}
+			if (m_Pages[page].empty())
+			{
+				m_Pages[page].assign(PageSize, NONE);
+			}
+			return m_Pages[page][id % PageSize];
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,809 @@
+#ifndef MAU_SWISS_MAP_H
+#define MAU_SWISS_MAP_H
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if defined(__AVX2__)
+#	define MAU_SWISS_AVX2 1
+#	include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#	define MAU_SWISS_SSE2 1
+#	include <emmintrin.h>
+#endif
+
+namespace Mau
+{
+	// Where SwissMap keeps its elements
+	enum class SwissStorage
+	{
+		// Inline in the slot array: no allocation per element, but elements move when the table grows
+		Flat,
+		// One heap node per element and a pointer per slot: references stay valid when the table grows
+		Node
+	};
+
+	namespace SwissDetail
+	{
+		// One control byte per slot. A full slot holds the low 7 bits of its hash (H2), empty and deleted slots
+		// are the only negative values, so a single movemask tells them apart from the full ones.
+		enum : int8_t
+		{
+			CTRL_EMPTY = -128,
+			CTRL_DELETED = -2
+		};
+
+		// Bit i is set for slot i of a group
+		using BitMask = uint32_t;
+
+		// WIDTH consecutive control bytes, compared against a value all at once
+	#if defined(MAU_SWISS_AVX2)
+		class Group final
+		{
+		public:
+			static constexpr size_t WIDTH{ 32 };
+
+			explicit Group(int8_t const* ctrl) noexcept
+				: m_Ctrl{ _mm256_loadu_si256(reinterpret_cast<__m256i const*>(ctrl)) }
+			{
+			}
+
+			[[nodiscard]] BitMask Match(int8_t value) const noexcept
+			{
+				return static_cast<BitMask>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(m_Ctrl, _mm256_set1_epi8(value))));
+			}
+
+			[[nodiscard]] BitMask MatchEmptyOrDeleted() const noexcept
+			{
+				return static_cast<BitMask>(_mm256_movemask_epi8(m_Ctrl));
+			}
+
+			[[nodiscard]] BitMask MatchFull() const noexcept
+			{
+				return ~MatchEmptyOrDeleted();
+			}
+
+		private:
+			__m256i m_Ctrl;
+		};
+	#elif defined(MAU_SWISS_SSE2)
+		class Group final
+		{
+		public:
+			static constexpr size_t WIDTH{ 16 };
+
+			explicit Group(int8_t const* ctrl) noexcept
+				: m_Ctrl{ _mm_loadu_si128(reinterpret_cast<__m128i const*>(ctrl)) }
+			{
+			}
+
+			[[nodiscard]] BitMask Match(int8_t value) const noexcept
+			{
+				return static_cast<BitMask>(_mm_movemask_epi8(_mm_cmpeq_epi8(m_Ctrl, _mm_set1_epi8(value))));
+			}
+
+			[[nodiscard]] BitMask MatchEmptyOrDeleted() const noexcept
+			{
+				return static_cast<BitMask>(_mm_movemask_epi8(m_Ctrl));
+			}
+
+			[[nodiscard]] BitMask MatchFull() const noexcept
+			{
+				return ~MatchEmptyOrDeleted() & 0xFFFFu;
+			}
+
+		private:
+			__m128i m_Ctrl;
+		};
+	#else
+		class Group final
+		{
+		public:
+			static constexpr size_t WIDTH{ 8 };
+
+			explicit Group(int8_t const* ctrl) noexcept
+			{
+				std::memcpy(m_Ctrl, ctrl, WIDTH);
+			}
+
+			[[nodiscard]] BitMask Match(int8_t value) const noexcept
+			{
+				BitMask mask{ 0 };
+				for (size_t i{ 0 }; i < WIDTH; ++i)
+				{
+					mask |= static_cast<BitMask>(m_Ctrl[i] == value) << i;
+				}
+				return mask;
+			}
+
+			[[nodiscard]] BitMask MatchEmptyOrDeleted() const noexcept
+			{
+				BitMask mask{ 0 };
+				for (size_t i{ 0 }; i < WIDTH; ++i)
+				{
+					mask |= static_cast<BitMask>(m_Ctrl[i] < 0) << i;
+				}
+				return mask;
+			}
+
+			[[nodiscard]] BitMask MatchFull() const noexcept
+			{
+				return ~MatchEmptyOrDeleted() & 0xFFu;
+			}
+
+		private:
+			int8_t m_Ctrl[WIDTH];
+		};
+	#endif
+
+		[[nodiscard]] static BitMask MatchEmpty(Group const& group) noexcept
+		{
+			return group.Match(CTRL_EMPTY);
+		}
+
+		// Empty slots at the end of a group's mask, counted from its last lane
+		[[nodiscard]] static size_t LeadingZeros(BitMask mask) noexcept
+		{
+			return static_cast<size_t>(std::countl_zero(mask)) - (32 - Group::WIDTH);
+		}
+
+		// std::hash of an integer is the identity, but both the probe start (H1) and the control byte (H2)
+		// need well spread bits: multiply by the golden ratio and fold the high half in
+		[[nodiscard]] static size_t Mix(size_t hash) noexcept
+		{
+			uint64_t const product{ static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ull };
+			return static_cast<size_t>(product ^ (product >> 32));
+		}
+	}
+
+	// Open addressing hash map in the style of Abseil's Swiss tables. Every slot has a control byte, and a lookup
+	// compares the 7 bit hash fragment of the key against a whole group of control bytes with one SIMD compare,
+	// so most probes touch one control line and only the slots whose fragment matches. Groups are probed
+	// quadratically from any slot; the first Group::WIDTH control bytes are mirrored behind the last one so a
+	// group load never wraps. Erased slots become tombstones unless no probe could have passed them, and a table
+	// that runs out of room because of tombstones is rebuilt at the same capacity instead of doubling.
+	template <typename Key, typename Mapped, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>, SwissStorage Storage = SwissStorage::Flat>
+	class SwissMap final
+	{
+	public:
+		using key_type = Key;
+		using mapped_type = Mapped;
+		using value_type = std::pair<Key const, Mapped>;
+		using hasher = Hash;
+		using key_equal = KeyEqual;
+		using size_type = size_t;
+
+	private:
+		using Group = SwissDetail::Group;
+		using Slot = std::conditional_t<Storage == SwissStorage::Node, value_type*, value_type>;
+
+	public:
+		// Walks the table a group at a time: the full slots of the current group are kept as a bit mask,
+		// so stepping to the next element is a count trailing zeros instead of a control byte scan
+		template <bool Const>
+		class Iterator final
+		{
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = SwissMap::value_type;
+			using difference_type = ptrdiff_t;
+			using reference = std::conditional_t<Const, value_type const&, value_type&>;
+			using pointer = std::conditional_t<Const, value_type const*, value_type*>;
+
+			Iterator() noexcept = default;
+
+			// iterator converts to const_iterator
+			template <bool OtherConst, typename = std::enable_if_t<Const && !OtherConst>>
+			Iterator(Iterator<OtherConst> const& other) noexcept
+				: m_Group{ other.m_Group }
+				, m_Slots{ other.m_Slots }
+				, m_CtrlEnd{ other.m_CtrlEnd }
+				, m_Offset{ other.m_Offset }
+				, m_Rest{ other.m_Rest }
+			{
+			}
+
+			[[nodiscard]] reference operator*() const noexcept
+			{
+				return SwissMap::Element(m_Slots[m_Offset]);
+			}
+
+			[[nodiscard]] pointer operator->() const noexcept
+			{
+				return &**this;
+			}
+
+			Iterator& operator++() noexcept
+			{
+				if (m_Rest != 0)
+				{
+					m_Offset = static_cast<size_t>(std::countr_zero(m_Rest));
+					m_Rest &= m_Rest - 1;
+				}
+				else
+				{
+					NextGroup();
+				}
+				return *this;
+			}
+
+			Iterator operator++(int) noexcept
+			{
+				Iterator const old{ *this };
+				++*this;
+				return old;
+			}
+
+			[[nodiscard]] bool operator==(Iterator const& other) const noexcept
+			{
+				return m_Group == other.m_Group && m_Offset == other.m_Offset;
+			}
+
+		private:
+			friend class SwissMap;
+			template <bool>
+			friend class Iterator;
+
+			using SlotPointer = std::conditional_t<Const, Slot const*, Slot*>;
+
+			// At slot index; stepping from a free slot moves to the next full one
+			Iterator(int8_t const* ctrl, SlotPointer slots, size_t capacity, size_t index) noexcept
+				: m_Group{ ctrl + (index & ~(Group::WIDTH - 1)) }
+				, m_Slots{ slots + (index & ~(Group::WIDTH - 1)) }
+				, m_CtrlEnd{ ctrl + capacity }
+				, m_Offset{ index & (Group::WIDTH - 1) }
+			{
+				if (m_Group != m_CtrlEnd)
+				{
+					m_Rest = Group{ m_Group }.MatchFull() & ~((SwissDetail::BitMask{ 2 } << m_Offset) - 1);
+				}
+			}
+
+			// Groups start at multiples of Group::WIDTH, so the mirrored control bytes are never read
+			void NextGroup() noexcept
+			{
+				for (m_Group += Group::WIDTH, m_Slots += Group::WIDTH; m_Group < m_CtrlEnd; m_Group += Group::WIDTH, m_Slots += Group::WIDTH)
+				{
+					SwissDetail::BitMask const full{ Group{ m_Group }.MatchFull() };
+					if (full != 0)
+					{
+						m_Offset = static_cast<size_t>(std::countr_zero(full));
+						m_Rest = full & (full - 1);
+						return;
+					}
+				}
+				m_Offset = 0;
+			}
+
+			int8_t const* m_Group{ nullptr };
+			SlotPointer m_Slots{ nullptr };
+			int8_t const* m_CtrlEnd{ nullptr };
+			size_t m_Offset{ 0 };
+			// Full slots of the group after m_Offset
+			SwissDetail::BitMask m_Rest{ 0 };
+		};
+		using iterator = Iterator<false>;
+		using const_iterator = Iterator<true>;
+
+		SwissMap() = default;
+
+		explicit SwissMap(size_t capacity, Hash const& hash = {}, KeyEqual const& equal = {})
+			: m_Hash{ hash }
+			, m_Equal{ equal }
+		{
+			reserve(capacity);
+		}
+
+		SwissMap(SwissMap const& other)
+			: m_Hash{ other.m_Hash }
+			, m_Equal{ other.m_Equal }
+		{
+			reserve(other.size());
+			for (value_type const& element : other)
+			{
+				try_emplace(element.first, element.second);
+			}
+		}
+
+		SwissMap(SwissMap&& other) noexcept
+		{
+			swap(other);
+		}
+
+		SwissMap& operator=(SwissMap const& other)
+		{
+			if (this != &other)
+			{
+				SwissMap copy{ other };
+				swap(copy);
+			}
+			return *this;
+		}
+
+		SwissMap& operator=(SwissMap&& other) noexcept
+		{
+			SwissMap moved{ std::move(other) };
+			swap(moved);
+			return *this;
+		}
+
+		~SwissMap()
+		{
+			DestroyElements();
+			Deallocate(m_Ctrl, m_Slots, m_Capacity);
+		}
+
+		[[nodiscard]] iterator begin() noexcept
+		{
+			return FirstFull<iterator>();
+		}
+
+		[[nodiscard]] const_iterator begin() const noexcept
+		{
+			return FirstFull<const_iterator>();
+		}
+
+		[[nodiscard]] iterator end() noexcept
+		{
+			return IteratorAt(m_Capacity);
+		}
+
+		[[nodiscard]] const_iterator end() const noexcept
+		{
+			return IteratorAt(m_Capacity);
+		}
+
+		[[nodiscard]] bool empty() const noexcept
+		{
+			return m_Size == 0;
+		}
+
+		[[nodiscard]] size_t size() const noexcept
+		{
+			return m_Size;
+		}
+
+		// Number of slots, at most 7/8 of them are used
+		[[nodiscard]] size_t bucket_count() const noexcept
+		{
+			return m_Capacity;
+		}
+
+		[[nodiscard]] float load_factor() const noexcept
+		{
+			return m_Capacity == 0 ? 0.0f : static_cast<float>(m_Size) / static_cast<float>(m_Capacity);
+		}
+
+		// Makes room for count elements without growing again
+		void reserve(size_t count)
+		{
+			if (count > m_Size + m_GrowthLeft)
+			{
+				Resize(CapacityFor(count));
+			}
+		}
+
+		template <typename... Args>
+		std::pair<iterator, bool> try_emplace(Key const& key, Args&&... args)
+		{
+			return TryEmplace(key, std::forward<Args>(args)...);
+		}
+
+		template <typename... Args>
+		std::pair<iterator, bool> try_emplace(Key&& key, Args&&... args)
+		{
+			return TryEmplace(std::move(key), std::forward<Args>(args)...);
+		}
+
+		template <typename K, typename M>
+		std::pair<iterator, bool> emplace(K&& key, M&& mapped)
+		{
+			return TryEmplace(Key(std::forward<K>(key)), std::forward<M>(mapped));
+		}
+
+		std::pair<iterator, bool> insert(std::pair<Key, Mapped> const& value)
+		{
+			return TryEmplace(value.first, value.second);
+		}
+
+		template <typename InputIt>
+		void insert(InputIt first, InputIt last)
+		{
+			if constexpr (std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<InputIt>::iterator_category>)
+			{
+				reserve(m_Size + static_cast<size_t>(std::distance(first, last)));
+			}
+			for (; first != last; ++first)
+			{
+				TryEmplace(first->first, first->second);
+			}
+		}
+
+		Mapped& operator[](Key const& key)
+		{
+			return TryEmplace(key).first->second;
+		}
+
+		[[nodiscard]] iterator find(Key const& key)
+		{
+			return IteratorAt(FindIndex(key));
+		}
+
+		[[nodiscard]] const_iterator find(Key const& key) const
+		{
+			return IteratorAt(FindIndex(key));
+		}
+
+		[[nodiscard]] bool contains(Key const& key) const
+		{
+			return FindIndex(key) != m_Capacity;
+		}
+
+		[[nodiscard]] size_t count(Key const& key) const
+		{
+			return contains(key) ? 1 : 0;
+		}
+
+		[[nodiscard]] Mapped& at(Key const& key)
+		{
+			size_t const index{ FindIndex(key) };
+			if (index == m_Capacity)
+			{
+				throw std::out_of_range{ "SwissMap::at" };
+			}
+			return ElementAt(index).second;
+		}
+
+		[[nodiscard]] Mapped const& at(Key const& key) const
+		{
+			size_t const index{ FindIndex(key) };
+			if (index == m_Capacity)
+			{
+				throw std::out_of_range{ "SwissMap::at" };
+			}
+			return ElementAt(index).second;
+		}
+
+		size_t erase(Key const& key)
+		{
+			size_t const index{ FindIndex(key) };
+			if (index == m_Capacity)
+			{
+				return 0;
+			}
+			EraseAt(index);
+			return 1;
+		}
+
+		// Other elements never move on erase, so iterating and erasing in one pass is fine
+		iterator erase(const_iterator position)
+		{
+			size_t const index{ static_cast<size_t>(position.m_Group - m_Ctrl) + position.m_Offset };
+			EraseAt(index);
+
+			iterator next{ IteratorAt(index) };
+			++next;
+			return next;
+		}
+
+		// Keeps the slots, like std::unordered_map keeps its buckets
+		void clear() noexcept
+		{
+			DestroyElements();
+			if (m_Capacity != 0)
+			{
+				std::memset(m_Ctrl, SwissDetail::CTRL_EMPTY, m_Capacity + Group::WIDTH);
+			}
+			m_Size = 0;
+			m_GrowthLeft = MaxLoad(m_Capacity);
+		}
+
+		void swap(SwissMap& other) noexcept
+		{
+			using std::swap;
+			swap(m_Ctrl, other.m_Ctrl);
+			swap(m_Slots, other.m_Slots);
+			swap(m_Capacity, other.m_Capacity);
+			swap(m_Size, other.m_Size);
+			swap(m_GrowthLeft, other.m_GrowthLeft);
+			swap(m_Hash, other.m_Hash);
+			swap(m_Equal, other.m_Equal);
+		}
+
+	private:
+		static_assert(std::has_single_bit(Group::WIDTH));
+
+		// Control bytes for m_Capacity slots and Group::WIDTH mirrored ones behind them
+		int8_t* m_Ctrl{ nullptr };
+		Slot* m_Slots{ nullptr };
+		size_t m_Capacity{ 0 };
+		size_t m_Size{ 0 };
+		// Empty slots that may still be filled before the table has to grow. Filling a tombstone does not count.
+		size_t m_GrowthLeft{ 0 };
+		[[no_unique_address]] Hash m_Hash{};
+		[[no_unique_address]] KeyEqual m_Equal{};
+
+		// At most 7/8 of the slots are full or deleted, so every probe sequence ends at an empty slot
+		[[nodiscard]] static constexpr size_t MaxLoad(size_t capacity) noexcept
+		{
+			return capacity - capacity / 8;
+		}
+
+		// Power of two, at least one group
+		[[nodiscard]] static size_t CapacityFor(size_t count) noexcept
+		{
+			size_t capacity{ Group::WIDTH };
+			while (MaxLoad(capacity) < count)
+			{
+				capacity *= 2;
+			}
+			return capacity;
+		}
+
+		static void Deallocate(int8_t* ctrl, Slot* slots, size_t capacity) noexcept
+		{
+			if (capacity != 0)
+			{
+				std::allocator<int8_t>{}.deallocate(ctrl, capacity + Group::WIDTH);
+				std::allocator<Slot>{}.deallocate(slots, capacity);
+			}
+		}
+
+		template <typename S>
+		[[nodiscard]] static auto& Element(S& slot) noexcept
+		{
+			if constexpr (Storage == SwissStorage::Node)
+			{
+				return *slot;
+			}
+			else
+			{
+				return slot;
+			}
+		}
+
+		[[nodiscard]] value_type& ElementAt(size_t index) const noexcept
+		{
+			return Element(m_Slots[index]);
+		}
+
+		[[nodiscard]] iterator IteratorAt(size_t index) noexcept
+		{
+			return { m_Ctrl, m_Slots, m_Capacity, index };
+		}
+
+		[[nodiscard]] const_iterator IteratorAt(size_t index) const noexcept
+		{
+			return { m_Ctrl, m_Slots, m_Capacity, index };
+		}
+
+		template <typename It>
+		[[nodiscard]] It FirstFull() const noexcept
+		{
+			It it{ m_Ctrl, m_Slots, m_Capacity, 0 };
+			if (m_Capacity != 0 && m_Ctrl[0] < 0)
+			{
+				++it;
+			}
+			return it;
+		}
+
+		void SetCtrl(size_t index, int8_t value) noexcept
+		{
+			m_Ctrl[index] = value;
+			if (index < Group::WIDTH)
+			{
+				m_Ctrl[m_Capacity + index] = value;
+			}
+		}
+
+		void DestroySlot(size_t index) noexcept
+		{
+			if constexpr (Storage == SwissStorage::Node)
+			{
+				delete m_Slots[index];
+			}
+			else
+			{
+				std::destroy_at(m_Slots + index);
+			}
+		}
+
+		void DestroyElements() noexcept
+		{
+			if constexpr (Storage == SwissStorage::Flat && std::is_trivially_destructible_v<value_type>)
+			{
+				return;
+			}
+			for (size_t i{ 0 }; i < m_Capacity && m_Size != 0; ++i)
+			{
+				if (m_Ctrl[i] >= 0)
+				{
+					DestroySlot(i);
+				}
+			}
+		}
+
+		// Slot holding key, m_Capacity when there is none
+		[[nodiscard]] size_t FindIndex(Key const& key) const
+		{
+			if (m_Capacity == 0)
+			{
+				return m_Capacity;
+			}
+			return FindIndex(key, SwissDetail::Mix(m_Hash(key)));
+		}
+
+		[[nodiscard]] size_t FindIndex(Key const& key, size_t hash) const
+		{
+			size_t const mask{ m_Capacity - 1 };
+			int8_t const h2{ static_cast<int8_t>(hash & 0x7F) };
+			size_t offset{ (hash >> 7) & mask };
+			for (size_t step{ Group::WIDTH };; step += Group::WIDTH)
+			{
+				Group const group{ m_Ctrl + offset };
+				for (SwissDetail::BitMask match{ group.Match(h2) }; match != 0; match &= match - 1)
+				{
+					size_t const index{ (offset + static_cast<size_t>(std::countr_zero(match))) & mask };
+					if (m_Equal(ElementAt(index).first, key))
+					{
+						return index;
+					}
+				}
+
+				// The key would have been placed in this empty slot
+				if (SwissDetail::MatchEmpty(group) != 0)
+				{
+					return m_Capacity;
+				}
+				offset = (offset + step) & mask;
+			}
+		}
+
+		// First empty or deleted slot on the probe sequence of hash
+		[[nodiscard]] size_t FindFreeIndex(size_t hash) const noexcept
+		{
+			size_t const mask{ m_Capacity - 1 };
+			size_t offset{ (hash >> 7) & mask };
+			for (size_t step{ Group::WIDTH };; step += Group::WIDTH)
+			{
+				SwissDetail::BitMask const free{ Group{ m_Ctrl + offset }.MatchEmptyOrDeleted() };
+				if (free != 0)
+				{
+					return (offset + static_cast<size_t>(std::countr_zero(free))) & mask;
+				}
+				offset = (offset + step) & mask;
+			}
+		}
+
+		template <typename K, typename... Args>
+		std::pair<iterator, bool> TryEmplace(K&& key, Args&&... args)
+		{
+			if (m_Capacity == 0)
+			{
+				Resize(Group::WIDTH);
+			}
+
+			size_t const hash{ SwissDetail::Mix(m_Hash(key)) };
+			size_t const found{ FindIndex(key, hash) };
+			if (found != m_Capacity)
+			{
+				return { IteratorAt(found), false };
+			}
+
+			size_t index{ FindFreeIndex(hash) };
+			if (m_GrowthLeft == 0 && m_Ctrl[index] == SwissDetail::CTRL_EMPTY)
+			{
+				RehashForInsert();
+				index = FindFreeIndex(hash);
+			}
+
+			// Constructed before the control byte is set, a throwing constructor leaves the map unchanged
+			if constexpr (Storage == SwissStorage::Node)
+			{
+				m_Slots[index] = new value_type(std::piecewise_construct, std::forward_as_tuple(std::forward<K>(key)), std::forward_as_tuple(std::forward<Args>(args)...));
+			}
+			else
+			{
+				std::construct_at(m_Slots + index, std::piecewise_construct, std::forward_as_tuple(std::forward<K>(key)), std::forward_as_tuple(std::forward<Args>(args)...));
+			}
+
+			m_GrowthLeft -= (m_Ctrl[index] == SwissDetail::CTRL_EMPTY) ? 1 : 0;
+			SetCtrl(index, static_cast<int8_t>(hash & 0x7F));
+			++m_Size;
+			return { IteratorAt(index), true };
+		}
+
+		void EraseAt(size_t index) noexcept
+		{
+			DestroySlot(index);
+			--m_Size;
+
+			// If the empty slots around index leave no run of a whole group full or deleted, no probe ever
+			// went past this slot and it can become empty again instead of a tombstone. A single group table
+			// is read whole by every probe, which stops at any empty slot.
+			size_t const mask{ m_Capacity - 1 };
+			SwissDetail::BitMask const emptyBefore{ SwissDetail::MatchEmpty(Group{ m_Ctrl + ((index - Group::WIDTH) & mask) }) };
+			SwissDetail::BitMask const emptyAfter{ SwissDetail::MatchEmpty(Group{ m_Ctrl + index }) };
+			bool const wasNeverFull{ m_Capacity == Group::WIDTH || (emptyBefore != 0 && emptyAfter != 0
+				&& SwissDetail::LeadingZeros(emptyBefore) + static_cast<size_t>(std::countr_zero(emptyAfter)) < Group::WIDTH) };
+
+			SetCtrl(index, wasNeverFull ? SwissDetail::CTRL_EMPTY : SwissDetail::CTRL_DELETED);
+			m_GrowthLeft += wasNeverFull ? 1 : 0;
+		}
+
+		// Out of empty slots. When a good part of the table is tombstones, rebuilding it at the same capacity
+		// frees them and leaves enough room for the next inserts; otherwise the table doubles.
+		void RehashForInsert()
+		{
+			bool const mostlyTombstones{ m_Capacity > Group::WIDTH && m_Size * 32 <= m_Capacity * 25 };
+			Resize(mostlyTombstones ? m_Capacity : m_Capacity * 2);
+		}
+
+		void Resize(size_t capacity)
+		{
+			int8_t* const oldCtrl{ m_Ctrl };
+			Slot* const oldSlots{ m_Slots };
+			size_t const oldCapacity{ m_Capacity };
+
+			m_Ctrl = std::allocator<int8_t>{}.allocate(capacity + Group::WIDTH);
+			try
+			{
+				m_Slots = std::allocator<Slot>{}.allocate(capacity);
+			}
+			catch (...)
+			{
+				std::allocator<int8_t>{}.deallocate(m_Ctrl, capacity + Group::WIDTH);
+				m_Ctrl = oldCtrl;
+				throw;
+			}
+			std::memset(m_Ctrl, SwissDetail::CTRL_EMPTY, capacity + Group::WIDTH);
+			m_Capacity = capacity;
+			m_GrowthLeft = MaxLoad(capacity) - m_Size;
+
+			// Every key is new to the table, so each one just takes the first free slot of its probe sequence
+			for (size_t i{ 0 }; i < oldCapacity; ++i)
+			{
+				if (oldCtrl[i] < 0)
+				{
+					continue;
+				}
+
+				size_t const hash{ SwissDetail::Mix(m_Hash(Element(oldSlots[i]).first)) };
+				size_t const index{ FindFreeIndex(hash) };
+				if constexpr (Storage == SwissStorage::Node)
+				{
+					m_Slots[index] = oldSlots[i];
+				}
+				else
+				{
+					std::construct_at(m_Slots + index, std::move(oldSlots[i]));
+					std::destroy_at(oldSlots + i);
+				}
+				SetCtrl(index, static_cast<int8_t>(hash & 0x7F));
+			}
+
+			Deallocate(oldCtrl, oldSlots, oldCapacity);
+		}
+	};
+
+	// Elements are moved into a bigger slot array when the table grows
+	template <typename Key, typename Mapped, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+	using SwissFlatMap = SwissMap<Key, Mapped, Hash, KeyEqual, SwissStorage::Flat>;
+
+	// Elements stay in their own node for their whole life, only the pointers to them move
+	template <typename Key, typename Mapped, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+	using SwissNodeMap = SwissMap<Key, Mapped, Hash, KeyEqual, SwissStorage::Node>;
+}
+
+#endif
@@ -30,12 +30,25 @@
 // http://www.open-std.org/jtc1/sc22/wg21/docs/papers/2019/p0429r6.pdf
 
 #include <stddef.h>
+#include <stdint.h>
 #include <algorithm>
 #include <functional>
 #include <initializer_list>
 #include <iterator>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#if defined(__AVX2__)
+#define STDEXT_FLATMAP_AVX2 1
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define STDEXT_FLATMAP_SSE2 1
+#include <emmintrin.h>
+#endif
+
 namespace stdext {
 
 namespace flatmap_detail {
@@ -118,45 +131,195 @@ namespace flatmap_detail {
         (void)dummy;
     }
 
-    template<class Predicate, class Head, class... Rest>
-    size_t partition_together(Predicate& pred, size_t left, size_t right, Head head, const Rest... rest) {
-        while (left < right) {
-            while (left != right && pred(*(head + left))) ++left;
-            while (left != right && !pred(*(head + (right-1)))) --right;
-            if (left + 1 < right) {
-                flatmap_detail::swap_together(left, right-1, head, rest...);
-                ++left;
-                --right;
+    // Pattern-defeating quicksort (after Orson Peters' pdqsort) over several parallel random access ranges.
+    // head holds the keys; every swap is applied to all ranges so each key keeps its mapped value.
+    // Insertion sort for short ranges, median-of-3 / ninther pivots, O(n) on sorted and reversed input,
+    // O(n log k) with k distinct keys, heapsort once too many partitions were unbalanced, O(log n) stack.
+    namespace pdq {
+        enum : size_t {
+            insertion_sort_threshold = 24,
+            ninther_threshold = 128,
+            partial_insertion_sort_limit = 8
+        };
+
+        template<class Compare, class Head, class... Rest>
+        void insertion_sort(Compare& less, size_t left, size_t right, Head head, Rest... rest) {
+            for (size_t i = left + 1; i < right; ++i) {
+                for (size_t j = i; j > left && less(*(head + j), *(head + (j-1))); --j) {
+                    flatmap_detail::swap_together(j, j-1, head, rest...);
+                }
             }
         }
-        return right;
-    }
 
-    template<class Compare, class Head, class... Rest>
-    void sort_together(Compare& less, size_t left, size_t right, Head head, Rest... rest) {
-        if (right - left >= 3) {
-            size_t pivot_idx = left + (right - left) / 2;
-            // Swap the pivot element all the way to the right.
-            if (pivot_idx != right - 1) {
-                flatmap_detail::swap_together(pivot_idx, right-1, head, rest...);
+        // Gives up after moving partial_insertion_sort_limit elements, returns whether the range is sorted
+        template<class Compare, class Head, class... Rest>
+        bool partial_insertion_sort(Compare& less, size_t left, size_t right, Head head, Rest... rest) {
+            size_t moves = 0;
+            for (size_t i = left + 1; i < right; ++i) {
+                size_t j = i;
+                for (; j > left && less(*(head + j), *(head + (j-1))); --j) {
+                    flatmap_detail::swap_together(j, j-1, head, rest...);
+                }
+                moves += i - j;
+                if (moves > partial_insertion_sort_limit) {
+                    return i + 1 == right;
+                }
             }
-            const auto& pivot_elt = *(head + (right-1));
-            auto less_than_pivot = [&](const auto& x) -> bool {
-                return less(x, pivot_elt);
-            };
-            size_t correct_pivot_idx = flatmap_detail::partition_together(less_than_pivot, left, right-1, head, rest...);
-            if (correct_pivot_idx != right-1) {
-                flatmap_detail::swap_together(correct_pivot_idx, right-1, head, rest...);
+            return true;
+        }
+
+        template<class Compare, class Head, class... Rest>
+        void sort2(Compare& less, size_t a, size_t b, Head head, Rest... rest) {
+            if (less(*(head + b), *(head + a))) {
+                flatmap_detail::swap_together(a, b, head, rest...);
             }
-            flatmap_detail::sort_together(less, left, correct_pivot_idx, head, rest...);
-            flatmap_detail::sort_together(less, correct_pivot_idx+1, right, head, rest...);
-        } else if (right - left == 2) {
-            if (less(*(head + left), *(head + (left+1)))) {
-                // nothing to do
-            } else {
-                flatmap_detail::swap_together(left, left+1, head, rest...);
+        }
+
+        template<class Compare, class Head, class... Rest>
+        void sort3(Compare& less, size_t a, size_t b, size_t c, Head head, Rest... rest) {
+            pdq::sort2(less, a, b, head, rest...);
+            pdq::sort2(less, b, c, head, rest...);
+            pdq::sort2(less, a, b, head, rest...);
+        }
+
+        template<class Compare, class Head, class... Rest>
+        void sift_down(Compare& less, size_t left, size_t root, size_t size, Head head, Rest... rest) {
+            while (true) {
+                size_t child = 2 * root + 1;
+                if (child >= size) {
+                    return;
+                }
+                if (child + 1 < size && less(*(head + (left + child)), *(head + (left + child + 1)))) {
+                    ++child;
+                }
+                if (!less(*(head + (left + root)), *(head + (left + child)))) {
+                    return;
+                }
+                flatmap_detail::swap_together(left + root, left + child, head, rest...);
+                root = child;
+            }
+        }
+
+        template<class Compare, class Head, class... Rest>
+        void heap_sort(Compare& less, size_t left, size_t right, Head head, Rest... rest) {
+            const size_t size = right - left;
+            for (size_t i = size / 2; i-- > 0; ) {
+                pdq::sift_down(less, left, i, size, head, rest...);
+            }
+            for (size_t end = size; end-- > 1; ) {
+                flatmap_detail::swap_together(left, left + end, head, rest...);
+                pdq::sift_down(less, left, 0, end, head, rest...);
+            }
+        }
+
+        // Pivot at left. Afterwards [left, p) < pivot, pivot at p, [p+1, right) >= pivot.
+        // already_partitioned is set when no element had to move.
+        template<class Compare, class Head, class... Rest>
+        size_t partition_right(Compare& less, size_t left, size_t right, bool& already_partitioned, Head head, Rest... rest) {
+            size_t i = left + 1;
+            size_t j = right - 1;
+            already_partitioned = true;
+            while (true) {
+                while (i <= j && less(*(head + i), *(head + left))) ++i;
+                while (i <= j && !less(*(head + j), *(head + left))) --j;
+                if (i >= j) break;
+                flatmap_detail::swap_together(i, j, head, rest...);
+                already_partitioned = false;
+                ++i;
+                --j;
+            }
+            flatmap_detail::swap_together(left, i-1, head, rest...);
+            return i-1;
+        }
+
+        // Pivot at left, elements equal to it go left. Afterwards [left, p] <= pivot, [p+1, right) > pivot.
+        template<class Compare, class Head, class... Rest>
+        size_t partition_left(Compare& less, size_t left, size_t right, Head head, Rest... rest) {
+            size_t i = left + 1;
+            size_t j = right - 1;
+            while (true) {
+                while (i <= j && !less(*(head + left), *(head + i))) ++i;
+                while (i <= j && less(*(head + left), *(head + j))) --j;
+                if (i >= j) break;
+                flatmap_detail::swap_together(i, j, head, rest...);
+                ++i;
+                --j;
             }
+            flatmap_detail::swap_together(left, i-1, head, rest...);
+            return i-1;
         }
+
+        template<class Compare, class Head, class... Rest>
+        void sort_loop(Compare& less, size_t left, size_t right, int bad_allowed, bool leftmost, Head head, Rest... rest) {
+            while (true) {
+                const size_t size = right - left;
+                if (size < insertion_sort_threshold) {
+                    pdq::insertion_sort(less, left, right, head, rest...);
+                    return;
+                }
+
+                // Move the median of 3 (or the pseudo-median of 9) to left, it becomes the pivot
+                const size_t mid = left + size / 2;
+                if (size > ninther_threshold) {
+                    pdq::sort3(less, left, mid, right-1, head, rest...);
+                    pdq::sort3(less, left+1, mid-1, right-2, head, rest...);
+                    pdq::sort3(less, left+2, mid+1, right-3, head, rest...);
+                    pdq::sort3(less, mid-1, mid, mid+1, head, rest...);
+                    flatmap_detail::swap_together(left, mid, head, rest...);
+                } else {
+                    pdq::sort3(less, mid, left, right-1, head, rest...);
+                }
+
+                // The element before the range is <= everything in it. If it equals the pivot,
+                // all elements equal to the pivot are already in their final place.
+                if (!leftmost && !less(*(head + (left-1)), *(head + left))) {
+                    left = pdq::partition_left(less, left, right, head, rest...) + 1;
+                    continue;
+                }
+
+                bool already_partitioned = false;
+                const size_t pivot_pos = pdq::partition_right(less, left, right, already_partitioned, head, rest...);
+                const size_t l_size = pivot_pos - left;
+                const size_t r_size = right - (pivot_pos + 1);
+
+                if (l_size < size / 8 || r_size < size / 8) {
+                    if (--bad_allowed == 0) {
+                        pdq::heap_sort(less, left, right, head, rest...);
+                        return;
+                    }
+                    // Break up the pattern that produced the bad pivot
+                    if (l_size >= insertion_sort_threshold) {
+                        flatmap_detail::swap_together(left, left + l_size / 4, head, rest...);
+                        flatmap_detail::swap_together(pivot_pos - 1, pivot_pos - l_size / 4, head, rest...);
+                    }
+                    if (r_size >= insertion_sort_threshold) {
+                        flatmap_detail::swap_together(pivot_pos + 1, pivot_pos + 1 + r_size / 4, head, rest...);
+                        flatmap_detail::swap_together(right - 1, right - r_size / 4, head, rest...);
+                    }
+                } else if (already_partitioned
+                    && pdq::partial_insertion_sort(less, left, pivot_pos, head, rest...)
+                    && pdq::partial_insertion_sort(less, pivot_pos + 1, right, head, rest...)) {
+                    return;
+                }
+
+                // Recurse into the smaller side, loop on the larger one
+                if (l_size < r_size) {
+                    pdq::sort_loop(less, left, pivot_pos, bad_allowed, leftmost, head, rest...);
+                    left = pivot_pos + 1;
+                    leftmost = false;
+                } else {
+                    pdq::sort_loop(less, pivot_pos + 1, right, bad_allowed, false, head, rest...);
+                    right = pivot_pos;
+                }
+            }
+        }
+    } // namespace pdq
+
+    template<class Compare, class Head, class... Rest>
+    void sort_together(Compare& less, size_t left, size_t right, Head head, Rest... rest) {
+        int log2 = 0;
+        for (size_t n = right - left; n > 1; n >>= 1) ++log2;
+        pdq::sort_loop(less, left, right, log2 + 1, true, head, rest...);
     }
 
     template<class Compare, class Head, class... Rest>
@@ -164,6 +327,459 @@ namespace flatmap_detail {
         flatmap_detail::sort_together(less, 0, head.size(), head.begin(), rest.begin()...);
     }
 
+    // Exponential search followed by a binary search: same result as std::lower_bound,
+    // but O(log d) when the answer is d elements away from first
+    template<class It, class T, class Compare>
+    It gallop_lower_bound(It first, It last, const T& value, Compare& less) {
+        const ptrdiff_t n = last - first;
+        ptrdiff_t prev = 0;
+        ptrdiff_t bound = 1;
+        while (bound < n && less(*(first + bound), value)) {
+            prev = bound + 1;
+            bound *= 2;
+        }
+        return std::lower_bound(first + prev, first + std::min(bound, n), value, std::ref(less));
+    }
+
+    // Same, but searching from last towards first
+    template<class It, class T, class Compare>
+    It gallop_lower_bound_backward(It first, It last, const T& value, Compare& less) {
+        const ptrdiff_t n = last - first;
+        ptrdiff_t prev = 0;
+        ptrdiff_t bound = 1;
+        while (bound <= n && !less(*(last - bound), value)) {
+            prev = bound;
+            bound *= 2;
+        }
+        return std::lower_bound(last - std::min(bound, n), last - prev, value, std::ref(less));
+    }
+
+    // Old run at least this many times longer than the tail switches merge_tail to galloping
+    enum : size_t { gallop_ratio = 8 };
+
+    // Element moves applied to the keys and every mapped container alike, a set passes no mapped containers
+    template<class... Containers>
+    void move_together(size_t to, size_t from, Containers&... cs) {
+        int dummy[] = {
+            0,
+            (cs[to] = std::move(cs[from]), 0) ...
+        };
+        (void)dummy;
+    }
+
+    template<class... Containers>
+    void move_backward_together(size_t first, size_t last, size_t d_last, Containers&... cs) {
+        int dummy[] = {
+            0,
+            (std::move_backward(cs.begin() + first, cs.begin() + last, cs.begin() + d_last), 0) ...
+        };
+        (void)dummy;
+    }
+
+    template<class... Containers>
+    void erase_tail_together(size_t first, Containers&... cs) {
+        int dummy[] = {
+            0,
+            (cs.erase(cs.begin() + first, cs.end()), 0) ...
+        };
+        (void)dummy;
+    }
+
+    template<class Tails, size_t... I, class... Containers>
+    void move_from_tails(size_t to, size_t from, Tails& tails, std::index_sequence<I...>, Containers&... cs) {
+        int dummy[] = {
+            0,
+            (cs[to] = std::move(std::get<I>(tails)[from]), 0) ...
+        };
+        (void)dummy;
+    }
+
+    // keys[0, old_size) and keys[old_size, size) are both sorted: merges the tail backward into place, so every
+    // old element moves at most once. On equal keys the old elements stay in front.
+    // A tail much smaller than the old run is merged by galloping: every tail element finds its place with
+    // an exponential search and the old elements in between move as one block, O(m log(n/m)) comparisons.
+    template<class Compare, class KeyContainer, class... MappedContainers>
+    void merge_backward(Compare& compare, size_t old_size, KeyContainer& keys, MappedContainers&... values) {
+        using Key = typename KeyContainer::value_type;
+
+        // Already in order when every new key sorts after the old ones (appending sorted data)
+        if (old_size == 0 || old_size == keys.size() || !bool(compare(keys[old_size], keys[old_size - 1]))) {
+            return;
+        }
+        bool const gallop = old_size / (keys.size() - old_size) >= gallop_ratio;
+
+        // Same allocators as the containers, a pmr-backed map keeps its temporaries on its own resource
+        std::tuple<KeyContainer, MappedContainers...> tails(
+            KeyContainer(std::make_move_iterator(keys.begin() + old_size), std::make_move_iterator(keys.end()), keys.get_allocator()),
+            MappedContainers(std::make_move_iterator(values.begin() + old_size), std::make_move_iterator(values.end()), values.get_allocator())...);
+        KeyContainer& tail_keys = std::get<0>(tails);
+        std::index_sequence_for<KeyContainer, MappedContainers...> const all;
+
+        // The old elements that go behind a tail element are the ones greater than it
+        auto not_greater = [&](const Key& a, const Key& b) { return !bool(compare(b, a)); };
+
+        size_t i = old_size;
+        size_t j = tail_keys.size();
+        size_t k = keys.size();
+        while (j != 0) {
+            if (gallop) {
+                auto kit = flatmap_detail::gallop_lower_bound_backward(keys.begin(), keys.begin() + i, tail_keys[j - 1], not_greater);
+                size_t const p = static_cast<size_t>(kit - keys.begin());
+                flatmap_detail::move_backward_together(p, i, k, keys, values...);
+                k -= i - p;
+                i = p;
+            } else if (i != 0 && compare(tail_keys[j - 1], keys[i - 1])) {
+                --k;
+                --i;
+                flatmap_detail::move_together(k, i, keys, values...);
+                continue;
+            }
+            --k;
+            --j;
+            flatmap_detail::move_from_tails(k, j, tails, all, keys, values...);
+        }
+    }
+
+    // keys[0, old_size) and keys[old_size, size) are both sorted and unique. Drops the tail elements whose key
+    // is already present (insert never overwrites), then merges the rest backward into place.
+    template<class Compare, class KeyContainer, class... MappedContainers>
+    void merge_tail(Compare& compare, size_t old_size, KeyContainer& keys, MappedContainers&... values) {
+        size_t const tail_size = keys.size() - old_size;
+        if (tail_size == 0 || old_size == 0) {
+            return;
+        }
+        bool const gallop = old_size / tail_size >= gallop_ratio;
+
+        // Both runs are sorted, so every search can start where the previous one ended
+        size_t kept = old_size;
+        auto search_from = keys.begin();
+        auto old_end = keys.begin() + old_size;
+        for (size_t i = old_size; i < keys.size(); ++i) {
+            if (gallop) {
+                search_from = flatmap_detail::gallop_lower_bound(search_from, old_end, keys[i], compare);
+            } else {
+                while (search_from != old_end && bool(compare(*search_from, keys[i]))) {
+                    ++search_from;
+                }
+            }
+            if (search_from != old_end && !bool(compare(keys[i], *search_from))) {
+                continue;
+            }
+            if (kept != i) {
+                flatmap_detail::move_together(kept, i, keys, values...);
+            }
+            ++kept;
+        }
+        flatmap_detail::erase_tail_together(kept, keys, values...);
+
+        flatmap_detail::merge_backward(compare, old_size, keys, values...);
+    }
+
+    template<class C> struct is_vector : std::false_type {};
+    template<class T, class A> struct is_vector<std::vector<T, A>> : std::true_type {};
+
+    // Arithmetic keys in a vector, ordered by std::less: lookups can compare raw values with a branchless search
+    template<class Key, class Compare, class KeyContainer>
+    using uses_branchless_search = std::integral_constant<bool,
+        std::is_arithmetic<Key>::value && !std::is_same<Key, bool>::value && is_vector<KeyContainer>::value &&
+        (std::is_same<Compare, std::less<Key>>::value || std::is_same<Compare, std::less<void>>::value)
+    >;
+
+    // Number of elements in [first, first + n) that are less than key. Only used on a few cache lines,
+    // so it always scans everything: no early exit to mispredict.
+    template<class T>
+    size_t count_less(const T* first, size_t n, T key) {
+        size_t count = 0;
+        for (size_t i = 0; i < n; ++i) {
+            count += (first[i] < key) ? 1 : 0;
+        }
+        return count;
+    }
+
+#if defined(STDEXT_FLATMAP_AVX2)
+    // Every compare yields -1 in the lanes that are less, subtracting it counts them per lane
+    inline size_t count_less(const int32_t* first, size_t n, int32_t key) {
+        const __m256i k = _mm256_set1_epi32(key);
+        __m256i acc = _mm256_setzero_si256();
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first + i));
+            acc = _mm256_sub_epi32(acc, _mm256_cmpgt_epi32(k, v));
+        }
+        alignas(32) int32_t lanes[8];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+        size_t count = 0;
+        for (int32_t lane : lanes) count += static_cast<size_t>(lane);
+        return count + flatmap_detail::count_less<int32_t>(first + i, n - i, key);
+    }
+
+    inline size_t count_less(const float* first, size_t n, float key) {
+        const __m256 k = _mm256_set1_ps(key);
+        __m256i acc = _mm256_setzero_si256();
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            const __m256 v = _mm256_loadu_ps(first + i);
+            acc = _mm256_sub_epi32(acc, _mm256_castps_si256(_mm256_cmp_ps(v, k, _CMP_LT_OQ)));
+        }
+        alignas(32) int32_t lanes[8];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+        size_t count = 0;
+        for (int32_t lane : lanes) count += static_cast<size_t>(lane);
+        return count + flatmap_detail::count_less<float>(first + i, n - i, key);
+    }
+
+    inline size_t count_less(const int64_t* first, size_t n, int64_t key) {
+        const __m256i k = _mm256_set1_epi64x(key);
+        __m256i acc = _mm256_setzero_si256();
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first + i));
+            acc = _mm256_sub_epi64(acc, _mm256_cmpgt_epi64(k, v));
+        }
+        alignas(32) int64_t lanes[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+        size_t count = 0;
+        for (int64_t lane : lanes) count += static_cast<size_t>(lane);
+        return count + flatmap_detail::count_less<int64_t>(first + i, n - i, key);
+    }
+
+    inline size_t count_less(const double* first, size_t n, double key) {
+        const __m256d k = _mm256_set1_pd(key);
+        __m256i acc = _mm256_setzero_si256();
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            const __m256d v = _mm256_loadu_pd(first + i);
+            acc = _mm256_sub_epi64(acc, _mm256_castpd_si256(_mm256_cmp_pd(v, k, _CMP_LT_OQ)));
+        }
+        alignas(32) int64_t lanes[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+        size_t count = 0;
+        for (int64_t lane : lanes) count += static_cast<size_t>(lane);
+        return count + flatmap_detail::count_less<double>(first + i, n - i, key);
+    }
+#elif defined(STDEXT_FLATMAP_SSE2)
+    inline size_t count_less(const int32_t* first, size_t n, int32_t key) {
+        const __m128i k = _mm_set1_epi32(key);
+        __m128i acc = _mm_setzero_si128();
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + i));
+            acc = _mm_sub_epi32(acc, _mm_cmplt_epi32(v, k));
+        }
+        alignas(16) int32_t lanes[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+        size_t count = 0;
+        for (int32_t lane : lanes) count += static_cast<size_t>(lane);
+        return count + flatmap_detail::count_less<int32_t>(first + i, n - i, key);
+    }
+
+    inline size_t count_less(const float* first, size_t n, float key) {
+        const __m128 k = _mm_set1_ps(key);
+        __m128i acc = _mm_setzero_si128();
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            const __m128 v = _mm_loadu_ps(first + i);
+            acc = _mm_sub_epi32(acc, _mm_castps_si128(_mm_cmplt_ps(v, k)));
+        }
+        alignas(16) int32_t lanes[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+        size_t count = 0;
+        for (int32_t lane : lanes) count += static_cast<size_t>(lane);
+        return count + flatmap_detail::count_less<float>(first + i, n - i, key);
+    }
+#endif
+
+    // std::lower_bound on raw values: the halving steps select the next base arithmetically instead of branching,
+    // and once the range fits in a few cache lines the rest is counted in one linear (SIMD) pass
+    template<class T>
+    size_t branchless_lower_bound(const T* first, size_t n, const T& key) {
+        constexpr size_t linear_size = (4 * 64) / sizeof(T);
+        const T* base = first;
+        while (n > linear_size) {
+            const size_t half = n / 2;
+            base += (base[half] < key) ? half : 0;
+            n -= half;
+        }
+        return static_cast<size_t>(base - first) + flatmap_detail::count_less(base, n, key);
+    }
+
+    // Integral keys ordered by std::less in vectors: stable_sort_together can use an LSD radix sort
+    template<class Key, class Mapped, class Compare, class KeyContainer, class MappedContainer>
+    using uses_radix_sort = std::integral_constant<bool,
+        std::is_integral<Key>::value && !std::is_same<Key, bool>::value &&
+        is_vector<KeyContainer>::value && is_vector<MappedContainer>::value && !std::is_same<Mapped, bool>::value &&
+        std::is_default_constructible<Mapped>::value &&
+        (std::is_same<Compare, std::less<Key>>::value || std::is_same<Compare, std::less<void>>::value)
+    >;
+
+    // Below this the histogram setup of the radix sort costs more than pdqsort
+    enum : size_t { radix_sort_threshold = 1024 };
+
+    // Scratch vector of T that takes its memory from the allocator of container, so a pmr-backed map
+    // does not fall back to the default heap for its temporaries
+    template<class T, class Container>
+    using scratch_vector = std::vector<T, typename std::allocator_traits<typename Container::allocator_type>::template rebind_alloc<T>>;
+
+    // Stable LSD radix sort of keys[first, last) on 8 bit digits, moving values along. All digit histograms are
+    // counted in one pass up front, and passes where every key has the same digit are skipped,
+    // so keys that only use the low bytes of a wide type cost fewer passes.
+    template<class KeyContainer, class MappedContainer>
+    void radix_sort_together(KeyContainer& keys, MappedContainer& values, size_t first, size_t last) {
+        using Key = typename KeyContainer::value_type;
+        using Mapped = typename MappedContainer::value_type;
+        using Unsigned = typename std::make_unsigned<Key>::type;
+        constexpr size_t passes = sizeof(Key);
+        constexpr Unsigned sign_flip = std::is_signed<Key>::value ? Unsigned(Unsigned(1) << (8 * sizeof(Key) - 1)) : Unsigned(0);
+
+        const size_t n = last - first;
+        auto digit = [](const Key& key, size_t pass) {
+            return static_cast<size_t>((static_cast<Unsigned>(static_cast<Unsigned>(key) ^ sign_flip) >> (8 * pass)) & 0xFF);
+        };
+
+        scratch_vector<size_t, KeyContainer> counts(passes * 256, 0, keys.get_allocator());
+        for (size_t i = first; i < last; ++i) {
+            for (size_t pass = 0; pass < passes; ++pass) {
+                ++counts[pass * 256 + digit(keys[i], pass)];
+            }
+        }
+
+        scratch_vector<Key, KeyContainer> key_buffer(n, keys.get_allocator());
+        scratch_vector<Mapped, MappedContainer> value_buffer(n, values.get_allocator());
+        Key* src_keys = keys.data() + first;
+        Mapped* src_values = values.data() + first;
+        Key* dst_keys = key_buffer.data();
+        Mapped* dst_values = value_buffer.data();
+
+        for (size_t pass = 0; pass < passes; ++pass) {
+            size_t* const count = counts.data() + pass * 256;
+            if (count[digit(src_keys[0], pass)] == n) {
+                continue;
+            }
+
+            size_t offset = 0;
+            for (size_t d = 0; d < 256; ++d) {
+                const size_t c = count[d];
+                count[d] = offset;
+                offset += c;
+            }
+            for (size_t i = 0; i < n; ++i) {
+                const size_t to = count[digit(src_keys[i], pass)]++;
+                dst_keys[to] = src_keys[i];
+                dst_values[to] = static_cast<Mapped&&>(src_values[i]);
+            }
+            std::swap(src_keys, dst_keys);
+            std::swap(src_values, dst_values);
+        }
+
+        // An odd number of passes leaves the result in the buffers
+        if (src_keys != keys.data() + first) {
+            std::copy(src_keys, src_keys + n, keys.data() + first);
+            std::move(src_values, src_values + n, values.data() + first);
+        }
+    }
+
+    // Puts keys[first, last) in order by sorting a permutation of their indices, then moves the elements of both
+    // containers along its cycles in place. Equal keys keep their original order.
+    template<class KeyContainer, class MappedContainer, class Compare>
+    void stable_sort_together(KeyContainer& keys, MappedContainer& values, size_t first, size_t last, Compare& compare, std::false_type) {
+        using Key = typename KeyContainer::value_type;
+        using Mapped = typename MappedContainer::value_type;
+
+        const size_t n = last - first;
+        scratch_vector<size_t, KeyContainer> order(n, keys.get_allocator());
+        for (size_t i = 0; i < n; ++i) {
+            order[i] = i;
+        }
+        // Ties go to the lower index, so the unstable sort, which needs no buffer, puts equal keys in input order
+        auto before = [&](size_t a, size_t b) {
+            if (bool(compare(keys[first + a], keys[first + b]))) {
+                return true;
+            }
+            return !bool(compare(keys[first + b], keys[first + a])) && a < b;
+        };
+        flatmap_detail::sort_together(before, 0, n, order.begin());
+
+        // order[j] is the index of the element that belongs at j, placed ones are marked with order[j] == j
+        for (size_t i = 0; i < n; ++i) {
+            if (order[i] == i) {
+                continue;
+            }
+            Key key = static_cast<Key&&>(keys[first + i]);
+            Mapped value = static_cast<Mapped&&>(values[first + i]);
+            size_t j = i;
+            while (order[j] != i) {
+                const size_t from = order[j];
+                keys[first + j] = static_cast<Key&&>(keys[first + from]);
+                values[first + j] = static_cast<Mapped&&>(values[first + from]);
+                order[j] = j;
+                j = from;
+            }
+            keys[first + j] = static_cast<Key&&>(key);
+            values[first + j] = static_cast<Mapped&&>(value);
+            order[j] = j;
+        }
+    }
+
+    // The radix sort is stable already
+    template<class KeyContainer, class MappedContainer, class Compare>
+    void stable_sort_together(KeyContainer& keys, MappedContainer& values, size_t first, size_t last, Compare& compare, std::true_type) {
+        if (last - first >= radix_sort_threshold) {
+            flatmap_detail::radix_sort_together(keys, values, first, last);
+        } else {
+            flatmap_detail::stable_sort_together(keys, values, first, last, compare, std::false_type());
+        }
+    }
+
+    // Presorted input is common (appending in order) and would still pay for the whole sort. Strictly decreasing
+    // input only needs reversing; with equal keys reversing would change their order, so those are sorted.
+    template<class KeyContainer, class MappedContainer, class Compare>
+    void stable_sort_together(KeyContainer& keys, MappedContainer& values, size_t first, size_t last, Compare& compare) {
+        using Key = typename KeyContainer::value_type;
+        using Mapped = typename MappedContainer::value_type;
+
+        auto kfirst = keys.begin() + first;
+        auto klast = keys.begin() + last;
+        if (std::is_sorted(kfirst, klast, std::ref(compare))) {
+            return;
+        }
+        if (std::adjacent_find(kfirst, klast, [&](const Key& a, const Key& b) { return !bool(compare(b, a)); }) == klast) {
+            std::reverse(kfirst, klast);
+            std::reverse(values.begin() + first, values.begin() + last);
+            return;
+        }
+        flatmap_detail::stable_sort_together(keys, values, first, last, compare, uses_radix_sort<Key, Mapped, Compare, KeyContainer, MappedContainer>());
+    }
+
+    // Removes the elements at the indices >= first for which remove(i) is true from both parallel containers,
+    // in one stable pass: every kept element moves at most once, and each container is shrunk once at the end.
+    // remove is called with increasing indices and only sees elements that have not been moved yet.
+    template<class KeyContainer, class MappedContainer, class Remove>
+    size_t compact_together(KeyContainer& keys, MappedContainer& values, size_t first, Remove remove) {
+        using Key = typename KeyContainer::value_type;
+        using Mapped = typename MappedContainer::value_type;
+
+        size_t const n = keys.size();
+        size_t i = first;
+        while (i != n && !remove(i)) {
+            ++i;
+        }
+        if (i == n) {
+            return 0;
+        }
+
+        size_t kept = i;
+        for (++i; i != n; ++i) {
+            if (!remove(i)) {
+                keys[kept] = static_cast<Key&&>(keys[i]);
+                values[kept] = static_cast<Mapped&&>(values[i]);
+                ++kept;
+            }
+        }
+        keys.erase(keys.begin() + kept, keys.end());
+        values.erase(values.begin() + kept, values.end());
+        return n - kept;
+    }
+
     template<class It, class It2, class Compare>
     It unique_helper(It first, It last, It2 mapped, Compare& compare) {
         It dfirst = first;
@@ -188,6 +804,29 @@ namespace flatmap_detail {
         return dfirst;
     }
 
+    // Same as unique_helper, but keeps the first element of every run of equal keys: after a stable sort
+    // that is the one inserted first, which is what inserting them one at a time would keep
+    template<class It, class It2, class Compare>
+    It unique_first_helper(It first, It last, It2 mapped, Compare& compare) {
+        if (first == last) {
+            return first;
+        }
+        It dfirst = first;
+        It2 dmapped = mapped;
+        while (++first != last) {
+            ++mapped;
+            if (bool(compare(*dfirst, *first))) {
+                ++dfirst;
+                ++dmapped;
+                if (dfirst != first) {
+                    *dfirst = std::move(*first);
+                    *dmapped = std::move(*mapped);
+                }
+            }
+        }
+        return ++dfirst;
+    }
+
     template<class, class> class iter;
     template<class K, class V> iter<K, V> make_iterator(K, V);
 
@@ -584,6 +1223,26 @@ public:
         return it->second;
     }
 
+    template<class K,
+             class Compare_ = Compare, class = typename Compare_::is_transparent>
+    mapped_reference at(const K& x) {
+        auto it = this->find(x);
+        if (it == end()) {
+            throw std::out_of_range("flat_map::at");
+        }
+        return it->second;
+    }
+
+    template<class K,
+             class Compare_ = Compare, class = typename Compare_::is_transparent>
+    const_mapped_reference at(const K& x) const {
+        auto it = this->find(x);
+        if (it == end()) {
+            throw std::out_of_range("flat_map::at");
+        }
+        return it->second;
+    }
+
     template<class... Args, class = decltype(std::pair<Key, Mapped>(std::declval<Args&&>()...), void())>
     std::pair<iterator, bool> emplace(Args&&... args) {
         std::pair<Key, Mapped> t(static_cast<Args&&>(args)...);
@@ -637,29 +1296,41 @@ public:
     template<class InputIterator,
              class = typename std::enable_if<flatmap_detail::qualifies_as_input_iterator<InputIterator>::value>::type>
     void insert(InputIterator first, InputIterator last) {
-        // TODO: if we're inserting lots of elements, stick them at the end and then sort
-        while (first != last) {
-            this->insert(*first);
-            ++first;
+        // Stick them at the end, sort and dedup just the new tail, then merge it into the old elements:
+        // O(n + m log m) instead of one O(n) vector insert per element. The tail is sorted stably and the first
+        // of equal keys is kept, so like inserting one at a time the first value inserted for a key wins.
+        const size_t old_size = this->size();
+        try {
+            while (first != last) {
+                c_.keys.insert(c_.keys.end(), first->first);
+                c_.values.insert(c_.values.end(), first->second);
+                ++first;
+            }
+            flatmap_detail::stable_sort_together(c_.keys, c_.values, old_size, c_.keys.size(), compare_);
+            auto kit = flatmap_detail::unique_first_helper(c_.keys.begin() + old_size, c_.keys.end(), c_.values.begin() + old_size, compare_);
+            this->erase_tail_impl(static_cast<size_t>(kit - c_.keys.begin()));
+            this->merge_tail_impl(old_size);
+        } catch (...) {
+            this->clear();
+            throw;
         }
     }
 
     template<class InputIterator,
              class = typename std::enable_if<flatmap_detail::qualifies_as_input_iterator<InputIterator>::value>::type>
     void insert(stdext::sorted_unique_t, InputIterator first, InputIterator last) {
-        // TODO: if InputIterator is bidirectional, this loop should (go backward??)
-        // TODO: if we're inserting lots of elements, stick them at the end and then sort
-        auto it = begin();
-        while (first != last) {
-            std::pair<Key, Mapped> t(*first);
-            it = std::partition_point(it, this->end(), [&](const auto& elt) {
-                return bool(compare_(elt.first, t.first));
-            });
-            if (it == this->end() || bool(compare_(t.first, it->first))) {
-                it = this->emplace(it, std::move(t));
+        // The input is already sorted and unique, so it only needs to be appended and merged in
+        const size_t old_size = this->size();
+        try {
+            while (first != last) {
+                c_.keys.insert(c_.keys.end(), first->first);
+                c_.values.insert(c_.values.end(), first->second);
+                ++first;
             }
-            ++it;
-            ++first;
+            this->merge_tail_impl(old_size);
+        } catch (...) {
+            this->clear();
+            throw;
         }
     }
 
@@ -699,7 +1370,7 @@ public:
 
     template<class... Args>
     std::pair<iterator, bool> try_emplace(const Key& k, Args&&... args) {
-        auto kit = std::lower_bound(c_.keys.begin(), c_.keys.end(), k, std::ref(compare_));
+        auto kit = c_.keys.begin() + this->lower_bound_index(k);
         auto vit = c_.values.begin() + (kit - c_.keys.begin());
         if (kit == c_.keys.end() || compare_(k, *kit)) {
             kit = c_.keys.insert(kit, k);
@@ -713,7 +1384,7 @@ public:
 
     template<class... Args>
     std::pair<iterator, bool> try_emplace(Key&& k, Args&&... args) {
-        auto kit = std::lower_bound(c_.keys.begin(), c_.keys.end(), k, std::ref(compare_));
+        auto kit = c_.keys.begin() + this->lower_bound_index(k);
         auto vit = c_.values.begin() + (kit - c_.keys.begin());
         if (kit == c_.keys.end() || compare_(k, *kit)) {
             kit = c_.keys.insert(kit, static_cast<Key&&>(k));
@@ -810,6 +1481,19 @@ public:
         return 0;
     }
 
+    // Iterators keep selecting the positional erase
+    template<class K,
+             class Compare_ = Compare, class = typename Compare_::is_transparent,
+             class = typename std::enable_if<!std::is_convertible<const K&, const_iterator>::value>::type>
+    size_type erase(const K& x) {
+        auto it = this->find(x);
+        if (it != this->end()) {
+            this->erase(it);
+            return 1;
+        }
+        return 0;
+    }
+
     iterator erase(const_iterator first, const_iterator last) {
         auto kfirst = first.private_impl_getkey();
         auto vfirst = first.private_impl_getmapped();
@@ -821,6 +1505,43 @@ public:
         return flatmap_detail::make_iterator(kitmut, vitmut);
     }
 
+    // Erases every key of the sorted, duplicate free range [first, last) in one pass over the map,
+    // instead of shifting both containers once per key. Returns the number of erased elements.
+    template<class InputIterator,
+             class = typename std::enable_if<flatmap_detail::qualifies_as_input_iterator<InputIterator>::value>::type>
+    size_type erase(sorted_unique_t, InputIterator first, InputIterator last) {
+        if (first == last) {
+            return 0;
+        }
+
+        // Everything before the first erased key stays where it is
+        size_t const start = static_cast<size_t>(this->lower_bound_index(*first));
+        try {
+            return flatmap_detail::compact_together(c_.keys, c_.values, start, [&](size_t i) {
+                while (first != last && compare_(*first, c_.keys[i])) {
+                    ++first;
+                }
+                return first != last && !compare_(c_.keys[i], *first);
+            });
+        } catch (...) {
+            this->clear();
+            throw;
+        }
+    }
+
+    // Erases every element for which pred(const_reference) is true in one stable pass. Returns the number of erased elements.
+    template<class Predicate>
+    friend size_type erase_if(flat_map& m, Predicate pred) {
+        try {
+            return flatmap_detail::compact_together(m.c_.keys, m.c_.values, 0, [&](size_t i) {
+                return bool(pred(const_reference{m.c_.keys[i], m.c_.values[i]}));
+            });
+        } catch (...) {
+            m.clear();
+            throw;
+        }
+    }
+
     void swap(flat_map& fm) noexcept
 #if defined(__cpp_lib_is_swappable)
         (std::is_nothrow_swappable<Compare>::value)
@@ -910,17 +1631,13 @@ public:
     }
 
     iterator lower_bound(const Key& k) {
-        auto kit = std::partition_point(c_.keys.begin(), c_.keys.end(), [&](const auto& elt) {
-            return bool(compare_(elt, k));
-        });
+        auto kit = c_.keys.begin() + this->lower_bound_index(k);
         auto vit = c_.values.begin() + (kit - c_.keys.begin());
         return flatmap_detail::make_iterator(kit, vit);
     }
 
     const_iterator lower_bound(const Key& k) const {
-        auto kit = std::partition_point(c_.keys.begin(), c_.keys.end(), [&](const auto& elt) {
-            return bool(compare_(elt, k));
-        });
+        auto kit = c_.keys.begin() + this->lower_bound_index(k);
         auto vit = c_.values.begin() + (kit - c_.keys.begin());
         return flatmap_detail::make_iterator(kit, vit);
     }
@@ -1046,9 +1763,35 @@ public:
     }
 
 private:
+    ptrdiff_t lower_bound_index(const Key& k) const {
+        return this->lower_bound_index(k, flatmap_detail::uses_branchless_search<Key, Compare, KeyContainer>());
+    }
+
+    ptrdiff_t lower_bound_index(const Key& k, std::true_type) const {
+        return static_cast<ptrdiff_t>(flatmap_detail::branchless_lower_bound(c_.keys.data(), c_.keys.size(), k));
+    }
+
+    ptrdiff_t lower_bound_index(const Key& k, std::false_type) const {
+        auto kit = std::partition_point(c_.keys.begin(), c_.keys.end(), [&](const auto& elt) {
+            return bool(compare_(elt, k));
+        });
+        return kit - c_.keys.begin();
+    }
+
+    void erase_tail_impl(size_t new_size) {
+        c_.keys.erase(c_.keys.begin() + new_size, c_.keys.end());
+        c_.values.erase(c_.values.begin() + new_size, c_.values.end());
+    }
+
+    // [0, old_size) and [old_size, size()) are both sorted and unique, see flatmap_detail::merge_tail
+    void merge_tail_impl(size_t old_size) {
+        flatmap_detail::merge_tail(compare_, old_size, c_.keys, c_.values);
+    }
+
+    // Same duplicate policy as insert(first, last): the first value given for a key is kept
     void sort_and_unique_impl() {
-        flatmap_detail::sort_together(compare_, c_.keys, c_.values);
-        auto kit = flatmap_detail::unique_helper(c_.keys.begin(), c_.keys.end(), c_.values.begin(), compare_);
+        flatmap_detail::stable_sort_together(c_.keys, c_.values, 0, c_.keys.size(), compare_);
+        auto kit = flatmap_detail::unique_first_helper(c_.keys.begin(), c_.keys.end(), c_.values.begin(), compare_);
         auto vit = c_.values.begin() + (kit - c_.keys.begin());
         auto it = flatmap_detail::make_iterator(kit, vit);
         this->erase(it, end());
@@ -0,0 +1,512 @@
+/*
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+// This is an implementation of the proposed "std::flat_multimap" as specified in
+// http://www.open-std.org/jtc1/sc22/wg21/docs/papers/2019/p0429r6.pdf
+// It shares the iterator, sorting and searching helpers of flat_map.h. The allocator-extended
+// constructors and the deduction guides are not provided.
+
+#include "flat_map.h"
+
+namespace stdext {
+
+#ifndef STDEXT_HAS_SORTED_EQUIVALENT
+#define STDEXT_HAS_SORTED_EQUIVALENT
+
+struct sorted_equivalent_t { explicit sorted_equivalent_t() = default; };
+
+#if defined(__cpp_inline_variables)
+inline
+#endif
+constexpr sorted_equivalent_t sorted_equivalent {};
+
+#endif // STDEXT_HAS_SORTED_EQUIVALENT
+
+template<
+    class Key,
+    class Mapped,
+    class Compare = std::less<Key>,
+    class KeyContainer = std::vector<Key>,
+    class MappedContainer = std::vector<Mapped>
+>
+class flat_multimap {
+    static_assert(flatmap_detail::is_random_access_iterator<typename KeyContainer::iterator>::value, "");
+    static_assert(flatmap_detail::is_random_access_iterator<typename MappedContainer::iterator>::value, "");
+    static_assert(std::is_same<Key, typename KeyContainer::value_type>::value, "");
+    static_assert(std::is_same<Mapped, typename MappedContainer::value_type>::value, "");
+    static_assert(!std::is_const<KeyContainer>::value && !std::is_const<Key>::value, "");
+    static_assert(!std::is_const<MappedContainer>::value && !std::is_const<Mapped>::value, "");
+    static_assert(!std::is_reference<KeyContainer>::value && !std::is_reference<Key>::value, "");
+    static_assert(!std::is_reference<MappedContainer>::value && !std::is_reference<Mapped>::value, "");
+    static_assert(std::is_convertible<decltype(std::declval<const Compare&>()(std::declval<const Key&>(), std::declval<const Key&>())), bool>::value, "");
+public:
+    using key_type = Key;
+    using mapped_type = Mapped;
+    using value_type = std::pair<const Key, Mapped>;
+    using key_compare = Compare;
+    using const_key_reference = typename KeyContainer::const_reference;
+    using mapped_reference = typename MappedContainer::reference;
+    using const_mapped_reference = typename MappedContainer::const_reference;
+    using reference = std::pair<const_key_reference, mapped_reference>;
+    using const_reference = std::pair<const_key_reference, const_mapped_reference>;
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+    using iterator = flatmap_detail::iter<typename KeyContainer::const_iterator, typename MappedContainer::iterator>;
+    using const_iterator = flatmap_detail::iter<typename KeyContainer::const_iterator, typename MappedContainer::const_iterator>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+    using key_container_type = KeyContainer;
+    using mapped_container_type = MappedContainer;
+
+    struct containers {
+        KeyContainer keys;
+        MappedContainer values;
+    };
+
+// =========================================================== CONSTRUCTORS
+
+    flat_multimap() : flat_multimap(Compare()) {}
+
+    explicit flat_multimap(const Compare& comp)
+        : c_(), compare_(comp) {}
+
+    flat_multimap(KeyContainer keys, MappedContainer values, const Compare& comp = Compare())
+        : c_{static_cast<KeyContainer&&>(keys), static_cast<MappedContainer&&>(values)}, compare_(comp)
+    {
+        this->stable_sort_tail_impl(0);
+    }
+
+    flat_multimap(sorted_equivalent_t, KeyContainer keys, MappedContainer values, const Compare& comp = Compare())
+        : c_{static_cast<KeyContainer&&>(keys), static_cast<MappedContainer&&>(values)}, compare_(comp) {}
+
+    template<class InputIterator,
+             class = typename std::enable_if<flatmap_detail::qualifies_as_input_iterator<InputIterator>::value>::type>
+    flat_multimap(InputIterator first, InputIterator last, const Compare& comp = Compare())
+        : c_(), compare_(comp)
+    {
+        this->insert(first, last);
+    }
+
+    template<class InputIterator,
+             class = typename std::enable_if<flatmap_detail::qualifies_as_input_iterator<InputIterator>::value>::type>
+    flat_multimap(sorted_equivalent_t, InputIterator first, InputIterator last, const Compare& comp = Compare())
+        : c_(), compare_(comp)
+    {
+        for (; first != last; ++first) {
+            c_.keys.insert(c_.keys.end(), first->first);
+            c_.values.insert(c_.values.end(), first->second);
+        }
+    }
+
+    flat_multimap(std::initializer_list<value_type> il, const Compare& comp = Compare())
+        : flat_multimap(il.begin(), il.end(), comp) {}
+
+    flat_multimap(sorted_equivalent_t s, std::initializer_list<value_type> il, const Compare& comp = Compare())
+        : flat_multimap(s, il.begin(), il.end(), comp) {}
+
+// ========================================================== OTHER MEMBERS
+
+    flat_multimap& operator=(std::initializer_list<value_type> il) {
+        this->clear();
+        this->insert(il);
+        return *this;
+    }
+
+    iterator begin() noexcept { return flatmap_detail::make_iterator(c_.keys.begin(), c_.values.begin()); }
+    const_iterator begin() const noexcept { return flatmap_detail::make_iterator(c_.keys.begin(), c_.values.begin()); }
+    iterator end() noexcept { return flatmap_detail::make_iterator(c_.keys.end(), c_.values.end()); }
+    const_iterator end() const noexcept { return flatmap_detail::make_iterator(c_.keys.end(), c_.values.end()); }
+
+    const_iterator cbegin() const noexcept { return flatmap_detail::make_iterator(c_.keys.begin(), c_.values.begin()); }
+    const_iterator cend() const noexcept { return flatmap_detail::make_iterator(c_.keys.end(), c_.values.end()); }
+
+    reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+    reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+    const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+
+    const_reverse_iterator crbegin() const noexcept { return const_reverse_iterator(end()); }
+    const_reverse_iterator crend() const noexcept { return const_reverse_iterator(begin()); }
+
+#if __cplusplus >= 201703L
+    [[nodiscard]]
+#endif
+    bool empty() const noexcept { return c_.keys.empty(); }
+    size_type size() const noexcept { return c_.keys.size(); }
+
+    // Like std::multimap, the new element goes after every element with an equal key
+    template<class... Args>
+    iterator emplace(Args&&... args) {
+        std::pair<Key, Mapped> t(static_cast<Args&&>(args)...);
+        auto kit = c_.keys.begin() + this->upper_bound_index(t.first);
+        auto vit = c_.values.begin() + (kit - c_.keys.begin());
+        kit = c_.keys.insert(kit, static_cast<Key&&>(t.first));
+        try {
+            vit = c_.values.insert(vit, static_cast<Mapped&&>(t.second));
+        } catch (...) {
+            c_.keys.erase(kit);
+            throw;
+        }
+        return flatmap_detail::make_iterator(kit, vit);
+    }
+
+    template<class... Args>
+    iterator emplace_hint(const_iterator, Args&&... args) {
+        return this->emplace(static_cast<Args&&>(args)...);
+    }
+
+    iterator insert(const value_type& x) {
+        return this->emplace(x);
+    }
+
+    iterator insert(value_type&& x) {
+        return this->emplace(static_cast<value_type&&>(x));
+    }
+
+    iterator insert(const_iterator position, const value_type& x) {
+        return this->emplace_hint(position, x);
+    }
+
+    iterator insert(const_iterator position, value_type&& x) {
+        return this->emplace_hint(position, static_cast<value_type&&>(x));
+    }
+
+    // Appends the new elements, stable sorts only them, then merges the two sorted runs. Equal keys keep
+    // their order: old elements first, then the new ones in input order, as repeated emplace would.
+    template<class InputIterator,
+             class = typename std::enable_if<flatmap_detail::qualifies_as_input_iterator<InputIterator>::value>::type>
+    void insert(InputIterator first, InputIterator last) {
+        size_t const old_size = this->size();
+        try {
+            for (; first != last; ++first) {
+                c_.keys.insert(c_.keys.end(), first->first);
+                c_.values.insert(c_.values.end(), first->second);
+            }
+            this->stable_sort_tail_impl(old_size);
+        } catch (...) {
+            this->clear();
+            throw;
+        }
+    }
+
+    template<class InputIterator,
+             class = typename std::enable_if<flatmap_detail::qualifies_as_input_iterator<InputIterator>::value>::type>
+    void insert(sorted_equivalent_t, InputIterator first, InputIterator last) {
+        size_t const old_size = this->size();
+        try {
+            for (; first != last; ++first) {
+                c_.keys.insert(c_.keys.end(), first->first);
+                c_.values.insert(c_.values.end(), first->second);
+            }
+            this->merge_tail_impl(old_size);
+        } catch (...) {
+            this->clear();
+            throw;
+        }
+    }
+
+    void insert(std::initializer_list<value_type> il) {
+        this->insert(il.begin(), il.end());
+    }
+
+    void insert(sorted_equivalent_t s, std::initializer_list<value_type> il) {
+        this->insert(s, il.begin(), il.end());
+    }
+
+    containers extract() && {
+        try {
+            containers result{
+                static_cast<KeyContainer&&>(c_.keys),
+                static_cast<MappedContainer&&>(c_.values)
+            };
+            this->clear();
+            return result;
+        } catch (...) {
+            this->clear();
+            throw;
+        }
+    }
+
+    // The keys must already be sorted with respect to key_comp()
+    void replace(KeyContainer&& keys, MappedContainer&& values) {
+        try {
+            c_.keys = static_cast<KeyContainer&&>(keys);
+            c_.values = static_cast<MappedContainer&&>(values);
+        } catch (...) {
+            this->clear();
+            throw;
+        }
+    }
+
+    iterator erase(const_iterator position) {
+        auto kitmut = c_.keys.erase(position.private_impl_getkey());
+        auto vitmut = c_.values.erase(position.private_impl_getmapped());
+        return flatmap_detail::make_iterator(kitmut, vitmut);
+    }
+
+    iterator erase(const_iterator first, const_iterator last) {
+        auto kitmut = c_.keys.erase(first.private_impl_getkey(), last.private_impl_getkey());
+        auto vitmut = c_.values.erase(first.private_impl_getmapped(), last.private_impl_getmapped());
+        return flatmap_detail::make_iterator(kitmut, vitmut);
+    }
+
+    // Removes every element with key k
+    size_type erase(const Key& k) {
+        auto range = this->equal_range(k);
+        size_type const n = static_cast<size_type>(range.second - range.first);
+        this->erase(range.first, range.second);
+        return n;
+    }
+
+    void swap(flat_multimap& fm) noexcept
+#if defined(__cpp_lib_is_swappable)
+        (std::is_nothrow_swappable<Compare>::value)
+#endif
+    {
+        using std::swap;
+        swap(compare_, fm.compare_);
+        swap(c_.keys, fm.c_.keys);
+        swap(c_.values, fm.c_.values);
+    }
+
+    void clear() noexcept {
+        c_.keys.clear();
+        c_.values.clear();
+    }
+
+    key_compare key_comp() const {
+        return compare_;
+    }
+
+    const KeyContainer& keys() const {
+        return c_.keys;
+    }
+
+    const MappedContainer& values() const {
+        return c_.values;
+    }
+
+    // The first element with key k
+    iterator find(const Key& k) {
+        auto it = this->lower_bound(k);
+        if (it == end() || compare_(k, it->first)) {
+            return end();
+        }
+        return it;
+    }
+
+    const_iterator find(const Key& k) const {
+        auto it = this->lower_bound(k);
+        if (it == end() || compare_(k, it->first)) {
+            return end();
+        }
+        return it;
+    }
+
+    size_type count(const Key& k) const {
+        auto range = this->equal_range(k);
+        return static_cast<size_type>(range.second - range.first);
+    }
+
+    bool contains(const Key& k) const {
+        return this->find(k) != this->end();
+    }
+
+    iterator lower_bound(const Key& k) {
+        return begin() + this->lower_bound_index(k);
+    }
+
+    const_iterator lower_bound(const Key& k) const {
+        return begin() + this->lower_bound_index(k);
+    }
+
+    iterator upper_bound(const Key& k) {
+        return begin() + this->upper_bound_index(k);
+    }
+
+    const_iterator upper_bound(const Key& k) const {
+        return begin() + this->upper_bound_index(k);
+    }
+
+    // Equal runs are usually short, so the end is found by galloping from the start instead of a second full search
+    std::pair<iterator, iterator> equal_range(const Key& k) {
+        auto range = this->equal_range_index(k);
+        return {begin() + range.first, begin() + range.second};
+    }
+
+    std::pair<const_iterator, const_iterator> equal_range(const Key& k) const {
+        auto range = this->equal_range_index(k);
+        return {begin() + range.first, begin() + range.second};
+    }
+
+    template<class K,
+             class Compare_ = Compare, class = typename Compare_::is_transparent>
+    iterator find(const K& x) {
+        auto it = this->lower_bound(x);
+        if (it == end() || compare_(x, it->first)) {
+            return end();
+        }
+        return it;
+    }
+
+    template<class K,
+             class Compare_ = Compare, class = typename Compare_::is_transparent>
+    const_iterator find(const K& x) const {
+        auto it = this->lower_bound(x);
+        if (it == end() || compare_(x, it->first)) {
+            return end();
+        }
+        return it;
+    }
+
+    template<class K,
+             class Compare_ = Compare, class = typename Compare_::is_transparent>
+    size_type count(const K& x) const {
+        auto range = this->equal_range(x);
+        return static_cast<size_type>(range.second - range.first);
+    }
+
+    template<class K,
+             class Compare_ = Compare, class = typename Compare_::is_transparent>
+    bool contains(const K& x) const {
+        return this->find(x) != this->end();
+    }
+
+    template<class K,
+             class Compare_ = Compare, class = typename Compare_::is_transparent>
+    iterator lower_bound(const K& x) {
+        return begin() + this->lower_bound_index(x);
+    }
+
+    template<class K,
+             class Compare_ = Compare, class = typename Compare_::is_transparent>
+    const_iterator lower_bound(const K& x) const {
+        return begin() + this->lower_bound_index(x);
+    }
+
+    template<class K,
+             class Compare_ = Compare, class = typename Compare_::is_transparent>
+    iterator upper_bound(const K& x) {
+        return begin() + this->upper_bound_index(x);
+    }
+
+    template<class K,
+             class Compare_ = Compare, class = typename Compare_::is_transparent>
+    const_iterator upper_bound(const K& x) const {
+        return begin() + this->upper_bound_index(x);
+    }
+
+    template<class K,
+             class Compare_ = Compare, class = typename Compare_::is_transparent>
+    std::pair<iterator, iterator> equal_range(const K& x) {
+        auto range = this->equal_range_index(x);
+        return {begin() + range.first, begin() + range.second};
+    }
+
+    template<class K,
+             class Compare_ = Compare, class = typename Compare_::is_transparent>
+    std::pair<const_iterator, const_iterator> equal_range(const K& x) const {
+        auto range = this->equal_range_index(x);
+        return {begin() + range.first, begin() + range.second};
+    }
+
+private:
+    ptrdiff_t lower_bound_index(const Key& k) const {
+        return this->lower_bound_index(k, flatmap_detail::uses_branchless_search<Key, Compare, KeyContainer>());
+    }
+
+    ptrdiff_t lower_bound_index(const Key& k, std::true_type) const {
+        return static_cast<ptrdiff_t>(flatmap_detail::branchless_lower_bound(c_.keys.data(), c_.keys.size(), k));
+    }
+
+    ptrdiff_t lower_bound_index(const Key& k, std::false_type) const {
+        auto kit = std::partition_point(c_.keys.begin(), c_.keys.end(), [&](const auto& elt) {
+            return bool(compare_(elt, k));
+        });
+        return kit - c_.keys.begin();
+    }
+
+    // Heterogeneous lookups compare against x directly instead of converting it to a Key
+    template<class K>
+    ptrdiff_t lower_bound_index(const K& x) const {
+        auto kit = std::partition_point(c_.keys.begin(), c_.keys.end(), [&](const auto& elt) {
+            return bool(compare_(elt, x));
+        });
+        return kit - c_.keys.begin();
+    }
+
+    template<class K>
+    ptrdiff_t upper_bound_index(const K& k) const {
+        auto kit = std::partition_point(c_.keys.begin(), c_.keys.end(), [&](const auto& elt) {
+            return !bool(compare_(k, elt));
+        });
+        return kit - c_.keys.begin();
+    }
+
+    template<class K>
+    std::pair<ptrdiff_t, ptrdiff_t> equal_range_index(const K& k) const {
+        ptrdiff_t const first = this->lower_bound_index(k);
+        auto greater = [&](const Key& elt, const K& key) { return !bool(compare_(key, elt)); };
+        auto kit = flatmap_detail::gallop_lower_bound(c_.keys.begin() + first, c_.keys.end(), k, greater);
+        return {first, kit - c_.keys.begin()};
+    }
+
+    // Sorts [old_size, size()) by key keeping equal keys in input order, then merges it in behind the old elements
+    void stable_sort_tail_impl(size_t old_size) {
+        flatmap_detail::stable_sort_together(c_.keys, c_.values, old_size, c_.keys.size(), compare_);
+        this->merge_tail_impl(old_size);
+    }
+
+    // [0, old_size) and [old_size, size()) are both sorted, see flatmap_detail::merge_backward
+    void merge_tail_impl(size_t old_size) {
+        flatmap_detail::merge_backward(compare_, old_size, c_.keys, c_.values);
+    }
+
+    containers c_;
+    Compare compare_;
+};
+
+template<class Key, class Mapped, class Compare, class KeyContainer, class MappedContainer>
+bool operator==(const flat_multimap<Key, Mapped, Compare, KeyContainer, MappedContainer>& x, const flat_multimap<Key, Mapped, Compare, KeyContainer, MappedContainer>& y)
+{
+    return std::equal(x.begin(), x.end(), y.begin(), y.end());
+}
+
+template<class Key, class Mapped, class Compare, class KeyContainer, class MappedContainer>
+bool operator!=(const flat_multimap<Key, Mapped, Compare, KeyContainer, MappedContainer>& x, const flat_multimap<Key, Mapped, Compare, KeyContainer, MappedContainer>& y)
+{
+    return !(x == y);
+}
+
+template<class Key, class Mapped, class Compare, class KeyContainer, class MappedContainer>
+void swap(flat_multimap<Key, Mapped, Compare, KeyContainer, MappedContainer>& x, flat_multimap<Key, Mapped, Compare, KeyContainer, MappedContainer>& y) noexcept(noexcept(x.swap(y)))
+{
+    return x.swap(y);
+}
+
+} // namespace stdext
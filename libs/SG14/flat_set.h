@@ -0,0 +1,427 @@
+/*
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+// This is an implementation of the proposed "std::flat_set" as specified in
+// http://www.open-std.org/jtc1/sc22/wg21/docs/papers/2020/p1222r1.pdf
+// It shares the sorting, searching and merging helpers of flat_map.h. The allocator-extended
+// constructors and the deduction guides are not provided.
+
+#include "flat_map.h"
+
+namespace stdext {
+
+template<
+    class Key,
+    class Compare = std::less<Key>,
+    class KeyContainer = std::vector<Key>
+>
+class flat_set {
+    static_assert(flatmap_detail::is_random_access_iterator<typename KeyContainer::iterator>::value, "");
+    static_assert(std::is_same<Key, typename KeyContainer::value_type>::value, "");
+    static_assert(!std::is_const<KeyContainer>::value && !std::is_const<Key>::value, "");
+    static_assert(!std::is_reference<KeyContainer>::value && !std::is_reference<Key>::value, "");
+    static_assert(std::is_convertible<decltype(std::declval<const Compare&>()(std::declval<const Key&>(), std::declval<const Key&>())), bool>::value, "");
+public:
+    using key_type = Key;
+    using value_type = Key;
+    using key_compare = Compare;
+    using value_compare = Compare;
+    using reference = Key&;
+    using const_reference = const Key&;
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+    // Elements are never modified in place, both iterators are const
+    using iterator = typename KeyContainer::const_iterator;
+    using const_iterator = typename KeyContainer::const_iterator;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+    using container_type = KeyContainer;
+
+// =========================================================== CONSTRUCTORS
+
+    flat_set() : flat_set(Compare()) {}
+
+    explicit flat_set(const Compare& comp)
+        : c_(), compare_(comp) {}
+
+    explicit flat_set(KeyContainer cont, const Compare& comp = Compare())
+        : c_(static_cast<KeyContainer&&>(cont)), compare_(comp)
+    {
+        this->sort_and_unique_impl();
+    }
+
+    flat_set(sorted_unique_t, KeyContainer cont, const Compare& comp = Compare())
+        : c_(static_cast<KeyContainer&&>(cont)), compare_(comp) {}
+
+    template<class InputIterator,
+             class = typename std::enable_if<flatmap_detail::qualifies_as_input_iterator<InputIterator>::value>::type>
+    flat_set(InputIterator first, InputIterator last, const Compare& comp = Compare())
+        : c_(), compare_(comp)
+    {
+        c_.insert(c_.end(), first, last);
+        this->sort_and_unique_impl();
+    }
+
+    template<class InputIterator,
+             class = typename std::enable_if<flatmap_detail::qualifies_as_input_iterator<InputIterator>::value>::type>
+    flat_set(sorted_unique_t, InputIterator first, InputIterator last, const Compare& comp = Compare())
+        : c_(first, last), compare_(comp) {}
+
+    flat_set(std::initializer_list<Key> il, const Compare& comp = Compare())
+        : flat_set(il.begin(), il.end(), comp) {}
+
+    flat_set(sorted_unique_t s, std::initializer_list<Key> il, const Compare& comp = Compare())
+        : flat_set(s, il.begin(), il.end(), comp) {}
+
+// ========================================================== OTHER MEMBERS
+
+    flat_set& operator=(std::initializer_list<Key> il) {
+        this->clear();
+        this->insert(il);
+        return *this;
+    }
+
+    iterator begin() const noexcept { return c_.begin(); }
+    iterator end() const noexcept { return c_.end(); }
+    const_iterator cbegin() const noexcept { return c_.begin(); }
+    const_iterator cend() const noexcept { return c_.end(); }
+
+    reverse_iterator rbegin() const noexcept { return reverse_iterator(end()); }
+    reverse_iterator rend() const noexcept { return reverse_iterator(begin()); }
+    const_reverse_iterator crbegin() const noexcept { return const_reverse_iterator(end()); }
+    const_reverse_iterator crend() const noexcept { return const_reverse_iterator(begin()); }
+
+#if __cplusplus >= 201703L
+    [[nodiscard]]
+#endif
+    bool empty() const noexcept { return c_.empty(); }
+    size_type size() const noexcept { return c_.size(); }
+    size_type max_size() const noexcept { return c_.max_size(); }
+
+    template<class... Args>
+    std::pair<iterator, bool> emplace(Args&&... args) {
+        Key k(static_cast<Args&&>(args)...);
+        return this->insert_unique_impl(static_cast<Key&&>(k));
+    }
+
+    template<class... Args>
+    iterator emplace_hint(const_iterator, Args&&... args) {
+        return this->emplace(static_cast<Args&&>(args)...).first;
+    }
+
+    std::pair<iterator, bool> insert(const Key& x) {
+        return this->insert_unique_impl(x);
+    }
+
+    std::pair<iterator, bool> insert(Key&& x) {
+        return this->insert_unique_impl(static_cast<Key&&>(x));
+    }
+
+    iterator insert(const_iterator, const Key& x) {
+        return this->insert(x).first;
+    }
+
+    iterator insert(const_iterator, Key&& x) {
+        return this->insert(static_cast<Key&&>(x)).first;
+    }
+
+    // Appends the new elements, sorts and deduplicates only them, then merges the two sorted runs.
+    // An element already in the set wins over an equal new one.
+    template<class InputIterator,
+             class = typename std::enable_if<flatmap_detail::qualifies_as_input_iterator<InputIterator>::value>::type>
+    void insert(InputIterator first, InputIterator last) {
+        size_t const old_size = c_.size();
+        try {
+            c_.insert(c_.end(), first, last);
+            flatmap_detail::sort_together(compare_, old_size, c_.size(), c_.begin());
+            auto kit = std::unique(c_.begin() + old_size, c_.end(), [&](const Key& a, const Key& b) {
+                return !bool(compare_(a, b));
+            });
+            c_.erase(kit, c_.end());
+            this->merge_tail_impl(old_size);
+        } catch (...) {
+            this->clear();
+            throw;
+        }
+    }
+
+    template<class InputIterator,
+             class = typename std::enable_if<flatmap_detail::qualifies_as_input_iterator<InputIterator>::value>::type>
+    void insert(sorted_unique_t, InputIterator first, InputIterator last) {
+        size_t const old_size = c_.size();
+        try {
+            c_.insert(c_.end(), first, last);
+            this->merge_tail_impl(old_size);
+        } catch (...) {
+            this->clear();
+            throw;
+        }
+    }
+
+    void insert(std::initializer_list<Key> il) {
+        this->insert(il.begin(), il.end());
+    }
+
+    void insert(sorted_unique_t s, std::initializer_list<Key> il) {
+        this->insert(s, il.begin(), il.end());
+    }
+
+    KeyContainer extract() && {
+        try {
+            KeyContainer result(static_cast<KeyContainer&&>(c_));
+            this->clear();
+            return result;
+        } catch (...) {
+            this->clear();
+            throw;
+        }
+    }
+
+    // The container must already be sorted and unique with respect to key_comp()
+    void replace(KeyContainer&& cont) {
+        try {
+            c_ = static_cast<KeyContainer&&>(cont);
+        } catch (...) {
+            this->clear();
+            throw;
+        }
+    }
+
+    iterator erase(const_iterator position) {
+        return c_.erase(position);
+    }
+
+    size_type erase(const Key& k) {
+        auto it = this->find(k);
+        if (it != this->end()) {
+            this->erase(it);
+            return 1;
+        }
+        return 0;
+    }
+
+    iterator erase(const_iterator first, const_iterator last) {
+        return c_.erase(first, last);
+    }
+
+    void swap(flat_set& fs) noexcept
+#if defined(__cpp_lib_is_swappable)
+        (std::is_nothrow_swappable<KeyContainer>::value && std::is_nothrow_swappable<Compare>::value)
+#endif
+    {
+        using std::swap;
+        swap(compare_, fs.compare_);
+        swap(c_, fs.c_);
+    }
+
+    void clear() noexcept {
+        c_.clear();
+    }
+
+    key_compare key_comp() const {
+        return compare_;
+    }
+
+    value_compare value_comp() const {
+        return compare_;
+    }
+
+    iterator find(const Key& k) const {
+        auto it = this->lower_bound(k);
+        if (it == end() || compare_(k, *it)) {
+            return end();
+        }
+        return it;
+    }
+
+    size_type count(const Key& k) const {
+        return this->contains(k) ? 1 : 0;
+    }
+
+    bool contains(const Key& k) const {
+        return this->find(k) != this->end();
+    }
+
+    iterator lower_bound(const Key& k) const {
+        return c_.begin() + this->lower_bound_index(k);
+    }
+
+    iterator upper_bound(const Key& k) const {
+        return std::partition_point(c_.begin(), c_.end(), [&](const auto& elt) {
+            return !bool(compare_(k, elt));
+        });
+    }
+
+    std::pair<iterator, iterator> equal_range(const Key& k) const {
+        auto first = this->lower_bound(k);
+        auto last = (first != end() && !bool(compare_(k, *first))) ? first + 1 : first;
+        return {first, last};
+    }
+
+    template<class K,
+             class Compare_ = Compare, class = typename Compare_::is_transparent>
+    iterator find(const K& x) const {
+        auto it = this->lower_bound(x);
+        if (it == end() || compare_(x, *it)) {
+            return end();
+        }
+        return it;
+    }
+
+    template<class K,
+             class Compare_ = Compare, class = typename Compare_::is_transparent>
+    size_type count(const K& x) const {
+        return this->contains(x) ? 1 : 0;
+    }
+
+    template<class K,
+             class Compare_ = Compare, class = typename Compare_::is_transparent>
+    bool contains(const K& x) const {
+        return this->find(x) != this->end();
+    }
+
+    template<class K,
+             class Compare_ = Compare, class = typename Compare_::is_transparent>
+    iterator lower_bound(const K& x) const {
+        return c_.begin() + this->lower_bound_index(x);
+    }
+
+    template<class K,
+             class Compare_ = Compare, class = typename Compare_::is_transparent>
+    iterator upper_bound(const K& x) const {
+        return std::partition_point(c_.begin(), c_.end(), [&](const auto& elt) {
+            return !bool(compare_(x, elt));
+        });
+    }
+
+    // A transparent comparator may consider several elements equivalent to x, so the end is searched for as well
+    template<class K,
+             class Compare_ = Compare, class = typename Compare_::is_transparent>
+    std::pair<iterator, iterator> equal_range(const K& x) const {
+        auto first = this->lower_bound(x);
+        auto last = std::partition_point(first, c_.end(), [&](const auto& elt) {
+            return !bool(compare_(x, elt));
+        });
+        return {first, last};
+    }
+
+private:
+    ptrdiff_t lower_bound_index(const Key& k) const {
+        return this->lower_bound_index(k, flatmap_detail::uses_branchless_search<Key, Compare, KeyContainer>());
+    }
+
+    ptrdiff_t lower_bound_index(const Key& k, std::true_type) const {
+        return static_cast<ptrdiff_t>(flatmap_detail::branchless_lower_bound(c_.data(), c_.size(), k));
+    }
+
+    ptrdiff_t lower_bound_index(const Key& k, std::false_type) const {
+        auto it = std::partition_point(c_.begin(), c_.end(), [&](const auto& elt) {
+            return bool(compare_(elt, k));
+        });
+        return it - c_.begin();
+    }
+
+    // Heterogeneous lookups compare against x directly instead of converting it to a Key
+    template<class K>
+    ptrdiff_t lower_bound_index(const K& x) const {
+        auto it = std::partition_point(c_.begin(), c_.end(), [&](const auto& elt) {
+            return bool(compare_(elt, x));
+        });
+        return it - c_.begin();
+    }
+
+    template<class K>
+    std::pair<iterator, bool> insert_unique_impl(K&& k) {
+        auto it = c_.begin() + this->lower_bound_index(k);
+        if (it == c_.end() || compare_(k, *it)) {
+            it = c_.insert(it, static_cast<K&&>(k));
+            return {it, true};
+        }
+        return {it, false};
+    }
+
+    // [0, old_size) and [old_size, size()) are both sorted and unique, see flatmap_detail::merge_tail
+    void merge_tail_impl(size_t old_size) {
+        flatmap_detail::merge_tail(compare_, old_size, c_);
+    }
+
+    void sort_and_unique_impl() {
+        flatmap_detail::sort_together(compare_, 0, c_.size(), c_.begin());
+        auto kit = std::unique(c_.begin(), c_.end(), [&](const Key& a, const Key& b) {
+            return !bool(compare_(a, b));
+        });
+        c_.erase(kit, c_.end());
+    }
+
+    KeyContainer c_;
+    Compare compare_;
+};
+
+template<class Key, class Compare, class KeyContainer>
+bool operator==(const flat_set<Key, Compare, KeyContainer>& x, const flat_set<Key, Compare, KeyContainer>& y)
+{
+    return std::equal(x.begin(), x.end(), y.begin(), y.end());
+}
+
+template<class Key, class Compare, class KeyContainer>
+bool operator!=(const flat_set<Key, Compare, KeyContainer>& x, const flat_set<Key, Compare, KeyContainer>& y)
+{
+    return !(x == y);
+}
+
+template<class Key, class Compare, class KeyContainer>
+bool operator<(const flat_set<Key, Compare, KeyContainer>& x, const flat_set<Key, Compare, KeyContainer>& y)
+{
+    return std::lexicographical_compare(x.begin(), x.end(), y.begin(), y.end());
+}
+
+template<class Key, class Compare, class KeyContainer>
+bool operator>(const flat_set<Key, Compare, KeyContainer>& x, const flat_set<Key, Compare, KeyContainer>& y)
+{
+    return y < x;
+}
+
+template<class Key, class Compare, class KeyContainer>
+bool operator<=(const flat_set<Key, Compare, KeyContainer>& x, const flat_set<Key, Compare, KeyContainer>& y)
+{
+    return !(y < x);
+}
+
+template<class Key, class Compare, class KeyContainer>
+bool operator>=(const flat_set<Key, Compare, KeyContainer>& x, const flat_set<Key, Compare, KeyContainer>& y)
+{
+    return !(x < y);
+}
+
+template<class Key, class Compare, class KeyContainer>
+void swap(flat_set<Key, Compare, KeyContainer>& x, flat_set<Key, Compare, KeyContainer>& y) noexcept(noexcept(x.swap(y)))
+{
+    return x.swap(y);
+}
+
+} // namespace stdext
@@ -0,0 +1,82 @@
+// Global operator new/delete replacement that reports every heap allocation to Mau::AllocTracker.
+// Only compiled in with the TRACK_ALLOCATIONS CMake option, since it adds a few atomics to every allocation.
+
+#include "alloc_tracker.h"
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+	// The requested size is stored right in front of the returned pointer, so unsized deletes can report it.
+	// The header is a full alignment unit to keep the returned pointer aligned.
+	size_t HeaderSize(size_t alignment) noexcept
+	{
+		return alignment < alignof(std::max_align_t) ? alignof(std::max_align_t) : alignment;
+	}
+
+	void* TrackedAlloc(size_t size, size_t alignment) noexcept
+	{
+		size_t const header{ HeaderSize(alignment) };
+		void* const base{ Mau::AlignedMalloc(size + header, header) };
+		if (!base)
+		{
+			return nullptr;
+		}
+
+		char* const user{ static_cast<char*>(base) + header };
+		*reinterpret_cast<size_t*>(user - sizeof(size_t)) = size;
+
+		Mau::AllocTracker::RecordAlloc(size);
+		return user;
+	}
+
+	void TrackedFree(void* ptr, size_t alignment) noexcept
+	{
+		if (!ptr)
+		{
+			return;
+		}
+
+		size_t const header{ HeaderSize(alignment) };
+		char* const user{ static_cast<char*>(ptr) };
+
+		Mau::AllocTracker::RecordFree(*reinterpret_cast<size_t*>(user - sizeof(size_t)));
+		Mau::AlignedFree(user - header, header);
+	}
+
+	void* TrackedAllocOrThrow(size_t size, size_t alignment)
+	{
+		void* const ptr{ TrackedAlloc(size == 0 ? 1 : size, alignment) };
+		if (!ptr)
+		{
+			throw std::bad_alloc{};
+		}
+		return ptr;
+	}
+}
+
+void* operator new(size_t size) { return TrackedAllocOrThrow(size, alignof(std::max_align_t)); }
+void* operator new[](size_t size) { return TrackedAllocOrThrow(size, alignof(std::max_align_t)); }
+void* operator new(size_t size, std::nothrow_t const&) noexcept { return TrackedAlloc(size == 0 ? 1 : size, alignof(std::max_align_t)); }
+void* operator new[](size_t size, std::nothrow_t const&) noexcept { return TrackedAlloc(size == 0 ? 1 : size, alignof(std::max_align_t)); }
+
+void* operator new(size_t size, std::align_val_t alignment) { return TrackedAllocOrThrow(size, static_cast<size_t>(alignment)); }
+void* operator new[](size_t size, std::align_val_t alignment) { return TrackedAllocOrThrow(size, static_cast<size_t>(alignment)); }
+void* operator new(size_t size, std::align_val_t alignment, std::nothrow_t const&) noexcept { return TrackedAlloc(size == 0 ? 1 : size, static_cast<size_t>(alignment)); }
+void* operator new[](size_t size, std::align_val_t alignment, std::nothrow_t const&) noexcept { return TrackedAlloc(size == 0 ? 1 : size, static_cast<size_t>(alignment)); }
+
+void operator delete(void* ptr) noexcept { TrackedFree(ptr, alignof(std::max_align_t)); }
+void operator delete[](void* ptr) noexcept { TrackedFree(ptr, alignof(std::max_align_t)); }
+void operator delete(void* ptr, size_t) noexcept { TrackedFree(ptr, alignof(std::max_align_t)); }
+void operator delete[](void* ptr, size_t) noexcept { TrackedFree(ptr, alignof(std::max_align_t)); }
+void operator delete(void* ptr, std::nothrow_t const&) noexcept { TrackedFree(ptr, alignof(std::max_align_t)); }
+void operator delete[](void* ptr, std::nothrow_t const&) noexcept { TrackedFree(ptr, alignof(std::max_align_t)); }
+
+void operator delete(void* ptr, std::align_val_t alignment) noexcept { TrackedFree(ptr, static_cast<size_t>(alignment)); }
+void operator delete[](void* ptr, std::align_val_t alignment) noexcept { TrackedFree(ptr, static_cast<size_t>(alignment)); }
+void operator delete(void* ptr, size_t, std::align_val_t alignment) noexcept { TrackedFree(ptr, static_cast<size_t>(alignment)); }
+void operator delete[](void* ptr, size_t, std::align_val_t alignment) noexcept { TrackedFree(ptr, static_cast<size_t>(alignment)); }
+void operator delete(void* ptr, std::align_val_t alignment, std::nothrow_t const&) noexcept { TrackedFree(ptr, static_cast<size_t>(alignment)); }
+void operator delete[](void* ptr, std::align_val_t alignment, std::nothrow_t const&) noexcept { TrackedFree(ptr, static_cast<size_t>(alignment)); }
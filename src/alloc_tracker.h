@@ -0,0 +1,178 @@
+#ifndef MAU_ALLOC_TRACKER_H
+#define MAU_ALLOC_TRACKER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+#if defined(_WIN32)
+#	ifndef NOMINMAX
+#		define NOMINMAX
+#	endif
+#	ifndef WIN32_LEAN_AND_MEAN
+#		define WIN32_LEAN_AND_MEAN
+#	endif
+#	include <malloc.h>
+#	include <windows.h>
+#	include <psapi.h>
+#else
+#	include <sys/resource.h>
+#endif
+
+namespace Mau
+{
+	// Process wide heap accounting, fed by CountingAllocator and (when built with TRACK_ALLOCATIONS) the global operator new/delete hook
+	class AllocTracker final
+	{
+	public:
+		struct Snapshot final
+		{
+			uint64_t count;
+			uint64_t bytes;
+			int64_t liveBytes;
+		};
+
+		static constexpr bool IsGlobalHookActive() noexcept
+		{
+		#if defined(MAU_TRACK_ALLOCATIONS)
+			return true;
+		#else
+			return false;
+		#endif
+		}
+
+		static void RecordAlloc(size_t bytes) noexcept
+		{
+			s_Count.fetch_add(1, std::memory_order_relaxed);
+			s_Bytes.fetch_add(bytes, std::memory_order_relaxed);
+
+			int64_t const live{ s_LiveBytes.fetch_add(static_cast<int64_t>(bytes), std::memory_order_relaxed) + static_cast<int64_t>(bytes) };
+			int64_t peak{ s_PeakLiveBytes.load(std::memory_order_relaxed) };
+			while (live > peak && !s_PeakLiveBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+			{
+			}
+		}
+
+		static void RecordFree(size_t bytes) noexcept
+		{
+			s_LiveBytes.fetch_sub(static_cast<int64_t>(bytes), std::memory_order_relaxed);
+		}
+
+		[[nodiscard]] static Snapshot Take() noexcept
+		{
+			return { s_Count.load(std::memory_order_relaxed), s_Bytes.load(std::memory_order_relaxed), s_LiveBytes.load(std::memory_order_relaxed) };
+		}
+
+		// Restart peak tracking from the current live byte count
+		static void ResetPeak() noexcept
+		{
+			s_PeakLiveBytes.store(s_LiveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		}
+
+		[[nodiscard]] static int64_t PeakLiveBytes() noexcept
+		{
+			return s_PeakLiveBytes.load(std::memory_order_relaxed);
+		}
+
+	private:
+		inline static std::atomic<uint64_t> s_Count{ 0 };
+		inline static std::atomic<uint64_t> s_Bytes{ 0 };
+		inline static std::atomic<int64_t> s_LiveBytes{ 0 };
+		inline static std::atomic<int64_t> s_PeakLiveBytes{ 0 };
+	};
+
+	// Raw allocation that never goes through operator new, so tracked memory is not counted twice when the global hook is active
+	[[nodiscard]] static void* AlignedMalloc(size_t bytes, size_t alignment) noexcept
+	{
+		if (alignment <= alignof(std::max_align_t))
+		{
+			return std::malloc(bytes);
+		}
+
+	#if defined(_WIN32)
+		return _aligned_malloc(bytes, alignment);
+	#else
+		// aligned_alloc requires the size to be a multiple of the alignment
+		return std::aligned_alloc(alignment, (bytes + alignment - 1) / alignment * alignment);
+	#endif
+	}
+
+	static void AlignedFree(void* ptr, size_t alignment) noexcept
+	{
+	#if defined(_WIN32)
+		if (alignment > alignof(std::max_align_t))
+		{
+			_aligned_free(ptr);
+			return;
+		}
+	#else
+		(void)alignment;
+	#endif
+		std::free(ptr);
+	}
+
+	// Drop-in container allocator that reports to AllocTracker (not final, standard containers derive from their allocator)
+	template <typename T>
+	class CountingAllocator
+	{
+	public:
+		using value_type = T;
+
+		CountingAllocator() noexcept = default;
+
+		template <typename U>
+		CountingAllocator(CountingAllocator<U> const&) noexcept {}
+
+		[[nodiscard]] T* allocate(size_t n)
+		{
+			size_t const bytes{ n * sizeof(T) };
+			void* const ptr{ AlignedMalloc(bytes, alignof(T)) };
+			if (!ptr)
+			{
+				throw std::bad_alloc{};
+			}
+
+			AllocTracker::RecordAlloc(bytes);
+			return static_cast<T*>(ptr);
+		}
+
+		void deallocate(T* ptr, size_t n) noexcept
+		{
+			AllocTracker::RecordFree(n * sizeof(T));
+			AlignedFree(ptr, alignof(T));
+		}
+
+		friend bool operator==(CountingAllocator const&, CountingAllocator const&) noexcept
+		{
+			return true;
+		}
+	};
+
+	// High-water mark of the resident set of the whole process, 0 when unsupported
+	[[nodiscard]] inline uint64_t GetPeakRssBytes() noexcept
+	{
+	#if defined(_WIN32)
+		PROCESS_MEMORY_COUNTERS counters{};
+		if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		{
+			return counters.PeakWorkingSetSize;
+		}
+		return 0;
+	#else
+		rusage usage{};
+		if (getrusage(RUSAGE_SELF, &usage) != 0)
+		{
+			return 0;
+		}
+	#	if defined(__APPLE__)
+		return static_cast<uint64_t>(usage.ru_maxrss);
+	#	else
+		return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+	#	endif
+	#endif
+	}
+}
+
+#endif
@@ -4,25 +4,143 @@
 #include "singleton.h"
 
 #include <functional>
+#include <memory>
 #include <algorithm>
 #include <numeric>
 #include <filesystem>
 #include <iostream>
 #include <fstream>
+#include <sstream>
+#include <iomanip>
 
 #include <string>
 #include <vector>
 
 #include <chrono>
+#include <barrier>
+#include <thread>
 #include <optional>
+#include <regex>
+#include <concepts>
 
 
 #include "benchmark_utils.h"
+#include "alloc_tracker.h"
+#include "benchmark_stats.h"
+#include "cycle_clock.h"
+#include "perf_counters.h"
+#include "process_isolation.h"
 
 namespace Mau
 {
 	using BenchmarkFunc = std::function<void()>;
 
+	// Fixture hooks operate on a per-benchmark state object, created fresh for every run
+	template <typename State>
+	using FixtureFunc = std::function<void(State&)>;
+
+	// A state with a size member opts into the size axis: the registry sets it to the current size point before setup
+	template <typename State>
+	concept SizedState = requires(State& state)
+	{
+		state.size = size_t{};
+	};
+
+	// A state with a threads member opts into the thread axis as a worker count: the registry sets it before setup,
+	// and func runs once per sample on the calling thread and spreads its work over that many threads itself
+	template <typename State>
+	concept WorkerState = requires(State& state)
+	{
+		state.threads = size_t{};
+	};
+
+	// Named values a benchmark reports next to its timings (probe lengths, latency percentiles, ...)
+	using BenchmarkMetrics = std::vector<std::pair<std::string, double>>;
+
+	// A state with a metrics member reports it with the result: the values left there when the last iteration's
+	// teardown has run. Names must not contain ',', ';', '=' or whitespace.
+	template <typename State>
+	concept MetricState = requires(State& state)
+	{
+		state.metrics = BenchmarkMetrics{};
+	};
+
+	struct BenchmarkConfig final
+	{
+		// Count hardware events (cycles, cache/TLB/branch misses) around every timed call; Linux only
+		bool perfCounters{ false };
+
+		// Untimed runs before sampling starts (caches, branch predictors, allocator pools)
+		size_t warmupIterations{ 1 };
+
+		// Adaptive mode ignores the registered iteration count: it samples until the relative standard error
+		// of the mean drops below rseThreshold or targetTimeMs is spent, bounded by min/maxIterations
+		bool adaptive{ false };
+		double targetTimeMs{ 2000.0 };
+		double rseThreshold{ 0.01 };
+		size_t minIterations{ 5 };
+		size_t maxIterations{ 10'000 };
+
+		// Thread counts for benchmarks registered with RegisterThreaded, empty means DefaultThreadCounts()
+		std::vector<size_t> threadCounts;
+
+		// Container sizes for benchmarks with a SizedState, empty means DefaultSizes()
+		std::vector<size_t> sizes;
+
+		// Benchmarks registered with RegisterMicro repeat their body until one sample takes at least this long
+		double minBatchTimeUs{ 100.0 };
+
+		// Overrides the iteration count every benchmark was registered with (fixed mode only)
+		std::optional<size_t> iterations;
+
+		// Run every benchmark point (benchmark x size x thread count) in its own forked process, so heap state and
+		// fragmentation left behind by earlier benchmarks cannot affect it. Linux only, runs in-process elsewhere.
+		bool isolate{ false };
+		// Pin to this core (threaded points use consecutive cores from here), so the scheduler cannot migrate the benchmark
+		std::optional<size_t> pinCpu;
+		// SCHED_FIFO priority, needs CAP_SYS_NICE
+		bool realtime{ false };
+	};
+
+	// Unset patterns match everything; a pattern matches when it is found anywhere in the name/category
+	struct BenchmarkFilter final
+	{
+		std::optional<std::regex> name;
+		std::optional<std::regex> category;
+	};
+
+	// minSize, minSize * factor, ... and maxSize itself as the last point
+	[[nodiscard]] static std::vector<size_t> GeometricSizes(size_t minSize, size_t maxSize, size_t factor) noexcept
+	{
+		std::vector<size_t> sizes;
+		for (size_t s{ std::max<size_t>(1, minSize) }; s < maxSize; s *= std::max<size_t>(2, factor))
+		{
+			sizes.emplace_back(s);
+		}
+		sizes.emplace_back(maxSize);
+		return sizes;
+	}
+
+	// 16 elements (fits in L1) up to 100M (far beyond any LLC)
+	[[nodiscard]] static std::vector<size_t> DefaultSizes() noexcept
+	{
+		return GeometricSizes(16, 100'000'000, 4);
+	}
+
+	// 1, 2, 4, ... up to and including hardware_concurrency
+	[[nodiscard]] static std::vector<size_t> DefaultThreadCounts() noexcept
+	{
+		size_t const hardwareThreads{ std::max<size_t>(1, std::thread::hardware_concurrency()) };
+
+		std::vector<size_t> counts;
+		for (size_t t{ 1 }; t < hardwareThreads; t *= 2)
+		{
+			counts.emplace_back(t);
+		}
+		counts.emplace_back(hardwareThreads);
+		return counts;
+	}
+
 	class BenchmarkRegistry final : public MauCor::Singleton<BenchmarkRegistry>
 	{
 	public:
@@ -31,43 +149,219 @@ namespace Mau
 			std::string name;
 			std::string category;
 
+			size_t size;
+			size_t threads;
 			size_t iterations;
+			// Calls of the body per sample, 1 unless registered with RegisterMicro. All per-iteration values are per call.
+			size_t batch;
 
 			double avgMs;
 			double totalMs;
 			double medianMs;
 			double minMs;
 			double maxMs;
+
+			double stddevMs;
+			double madMs;
+			double p90Ms;
+			double p99Ms;
+
+			// 95% bootstrap confidence interval of the median
+			double ciLowMs;
+			double ciHighMs;
+
+			// Body executions per second over all threads, and the latency of a single thread's call
+			double throughput;
+			double threadMedianMs;
+			double threadP99Ms;
+
+			// Median time of one thread's call, and that time divided by the container size. A micro benchmark's call
+			// touches a single element whatever the size, so its per element time is 0.
+			double nsPerOp;
+			double nsPerElement;
+
+			// Heap activity inside the timed call, averaged per iteration. Only allocations made through
+			// CountingAllocator are seen, unless the TRACK_ALLOCATIONS hook replaces the global operator new.
+			double allocations;
+			double allocatedBytes;
+			// Highest live heap above the level at the start of the timed call, over all iterations
+			double peakLiveBytes;
+			// Process wide high-water mark after the run, only per benchmark when running isolated
+			double peakRssBytes;
+
+			// Average per iteration, empty when counters were disabled or unavailable
+			std::optional<PerfCounterValues> counters;
+
+			// Every sample (time of one call) in nanoseconds, sorted. Stored so later runs can be tested against it.
+			std::vector<double> samplesNs;
+
+			// Reported by the benchmark itself, empty unless its state satisfies MetricState
+			BenchmarkMetrics metrics;
 		};
 
+		void SetConfig(BenchmarkConfig const& config) noexcept
+		{
+			m_Config = config;
+		}
+
+		[[nodiscard]] BenchmarkConfig const& GetConfig() const noexcept
+		{
+			return m_Config;
+		}
+
 		void Register(std::string const& name, std::string const& category, BenchmarkFunc const& func, size_t iterations = 10) noexcept
 		{
-			m_Benchmarks.emplace_back(name, category, func, iterations);
+			m_Benchmarks.emplace_back(name, category,
+				[func](size_t, size_t)
+				{
+					return BenchmarkInstance{ {}, func, {}, {} };
+				}, iterations);
+		}
+
+		// Setup and teardown run before/after every iteration, outside of the timed region.
+		// The state is default constructed when the benchmark starts and destroyed when it finishes,
+		// so a benchmark does not depend on any other benchmark having run before it.
+		// States satisfying SizedState are run for every size of the config's size axis up to maxSize,
+		// states satisfying WorkerState for every thread count of the thread axis.
+		template <typename State>
+		void Register(std::string const& name, std::string const& category, FixtureFunc<State> const& setup, FixtureFunc<State> const& func, FixtureFunc<State> const& teardown, size_t iterations = 10, size_t maxSize = std::numeric_limits<size_t>::max()) noexcept
+		{
+			m_Benchmarks.emplace_back(name, category, MakeFixtureFactory<State>(setup, func, teardown), iterations, WorkerState<State>, SizedState<State>, false, maxSize, WorkerState<State>);
+		}
+
+		// Same as the fixture Register, but func is also run on every thread count of the config's thread axis.
+		// All threads share one state object, so func must only read from it.
+		template <typename State>
+		void RegisterThreaded(std::string const& name, std::string const& category, FixtureFunc<State> const& setup, FixtureFunc<State> const& func, FixtureFunc<State> const& teardown, size_t iterations = 10, size_t maxSize = std::numeric_limits<size_t>::max()) noexcept
+		{
+			m_Benchmarks.emplace_back(name, category, MakeFixtureFactory<State>(setup, func, teardown), iterations, true, SizedState<State>, false, maxSize);
 		}
 
-		[[nodiscard]] std::vector<BenchmarkResult> RunAll(std::optional<std::vector <std::string>> categoryFilter = std::nullopt) const noexcept
+		// For bodies that take nanoseconds (a single find): every sample runs func a calibrated number of times in a row,
+		// and reports the time per call with the timer and call overhead subtracted. Setup and teardown run once per sample.
+		template <typename State>
+		void RegisterMicro(std::string const& name, std::string const& category, FixtureFunc<State> const& setup, FixtureFunc<State> const& func, FixtureFunc<State> const& teardown, size_t iterations = 10, size_t maxSize = std::numeric_limits<size_t>::max()) noexcept
+		{
+			m_Benchmarks.emplace_back(name, category, MakeFixtureFactory<State>(setup, func, teardown), iterations, false, SizedState<State>, true, maxSize);
+		}
+
+		[[nodiscard]] std::vector<BenchmarkResult> RunAll(BenchmarkFilter const& filter = {}) const noexcept
 		{
 			std::vector<BenchmarkResult> results;
 			results.reserve(m_Benchmarks.size());
 
+			if (m_Config.perfCounters && !PerfCounterGroup{}.IsAvailable())
+			{
+				std::cerr << "Warning: hardware performance counters are not available, falling back to timing only\n";
+			}
+
+			std::vector<size_t> const threadCounts{ m_Config.threadCounts.empty() ? DefaultThreadCounts() : m_Config.threadCounts };
+			std::vector<size_t> const sizes{ m_Config.sizes.empty() ? DefaultSizes() : m_Config.sizes };
+
+			// Benchmarks without an axis run once, with size 0 and a single thread
+			std::vector<size_t> const noSize{ 0 };
+			std::vector<size_t> const singleThread{ 1 };
+
+			bool const isolate{ m_Config.isolate && IsProcessIsolationSupported() };
+			if (m_Config.isolate && !isolate)
+			{
+				std::cerr << "Warning: process isolation is not supported on this platform, running in-process\n";
+			}
+
+			// Without isolation the whole process is pinned once, wide enough for the largest thread count
+			if (!isolate)
+			{
+				if (m_Config.pinCpu)
+				{
+					PinToCpus(*m_Config.pinCpu, *std::max_element(threadCounts.begin(), threadCounts.end()));
+				}
+				if (m_Config.realtime)
+				{
+					SetRealtimePriority();
+				}
+			}
+
 			for (auto const& b : m_Benchmarks)
 			{
-				if (categoryFilter)
+				if (!Matches(filter, b))
 				{
-					auto const& filters{ (*categoryFilter) };
-					if (!filters.empty() &&
-						std::find(filters.begin(), filters.end(), b.category) == filters.end())
+					continue;
+				}
+
+				for (size_t const size : (b.sized ? sizes : noSize))
+				{
+					if (size > b.maxSize)
 					{
 						continue;
 					}
-				}
 
-				results.emplace_back(RunBenchmark(b));
+					for (size_t const threads : (b.threaded ? threadCounts : singleThread))
+					{
+						if (!isolate)
+						{
+							results.emplace_back(RunBenchmark(b, m_Config, size, threads));
+							continue;
+						}
+
+						auto const payload
+						{
+							RunInChildProcess([&]()
+							{
+								if (m_Config.pinCpu)
+								{
+									PinToCpus(*m_Config.pinCpu, threads);
+								}
+								if (m_Config.realtime)
+								{
+									SetRealtimePriority();
+								}
+								return SerializeResult(RunBenchmark(b, m_Config, size, threads));
+							})
+						};
+
+						auto result{ payload ? DeserializeResult(*payload) : std::nullopt };
+						if (!result)
+						{
+							std::cerr << "Error: " << b.name << " (size " << size << ", " << threads << " threads) did not produce a result, skipping\n";
+							continue;
+						}
+
+						result->name = b.name;
+						result->category = b.category;
+						results.emplace_back(std::move(*result));
+					}
+				}
 			}
 
 			return results;
 		}
 
+		void List(std::ostream& out, BenchmarkFilter const& filter = {}) const noexcept
+		{
+			for (auto const& b : m_Benchmarks)
+			{
+				if (!Matches(filter, b))
+				{
+					continue;
+				}
+
+				out << b.category << " / " << b.name;
+				if (b.sized)
+				{
+					out << " [sizes]";
+				}
+				if (b.threaded)
+				{
+					out << " [threads]";
+				}
+				if (b.batched)
+				{
+					out << " [micro]";
+				}
+				out << "\n";
+			}
+		}
+
 		static bool WriteCsv(std::filesystem::path const& filePath, std::string const& compilerInfo, std::vector<BenchmarkResult> const& results) noexcept
 		{
 			std::ofstream out(filePath);
@@ -79,57 +373,191 @@ namespace Mau
 
 			out.imbue(std::locale::classic());
 			out << std::fixed << std::setprecision(6);
-			out << "Compiler,Benchmark,Category,Iterations,Average(Ms),Total(Ms),Median(Ms),Min(Ms),Max(Ms)\n";
+			out << CSV_HEADER << '\n';
 
 			for (auto const& r : results)
 			{
-				out << compilerInfo << ','
-					<< r.name << ','
-					<< r.category << ','
-					<< r.iterations << ','
-					<< r.avgMs << ','
-					<< r.totalMs << ','
-					<< r.medianMs << ','
-					<< r.minMs << ','
-					<< r.maxMs << '\n';
+				WriteCsvRow(out, compilerInfo, r);
+				out << '\n';
+			}
+
+			std::cout << "\nResults written to: " << filePath << "\n";
+			return true;
+		}
+
+		static bool WriteJson(std::filesystem::path const& filePath, std::string const& compilerInfo, std::vector<BenchmarkResult> const& results) noexcept
+		{
+			std::ofstream out(filePath);
+			if (!out.is_open())
+			{
+				std::cerr << "Error: could not write to " << filePath << "\n";
+				return false;
+			}
+
+			out.imbue(std::locale::classic());
+			out << std::setprecision(9);
+
+			auto quoted
+			{
+				[](std::string const& text)
+				{
+					std::string escaped{ "\"" };
+					for (char const c : text)
+					{
+						if (c == '"' || c == '\\')
+						{
+							escaped += '\\';
+						}
+						escaped += c;
+					}
+					return escaped + "\"";
+				}
+			};
+
+			out << "{\n  \"compiler\": " << quoted(compilerInfo) << ",\n  \"results\": [";
+			for (size_t i{ 0 }; i < results.size(); ++i)
+			{
+				auto const& r{ results[i] };
+				out << (i == 0 ? "\n" : ",\n")
+					<< "    { \"name\": " << quoted(r.name)
+					<< ", \"category\": " << quoted(r.category)
+					<< ", \"size\": " << r.size
+					<< ", \"threads\": " << r.threads
+					<< ", \"iterations\": " << r.iterations
+					<< ", \"batch\": " << r.batch
+					<< ", \"avgMs\": " << r.avgMs
+					<< ", \"totalMs\": " << r.totalMs
+					<< ", \"medianMs\": " << r.medianMs
+					<< ", \"minMs\": " << r.minMs
+					<< ", \"maxMs\": " << r.maxMs
+					<< ", \"stddevMs\": " << r.stddevMs
+					<< ", \"madMs\": " << r.madMs
+					<< ", \"p90Ms\": " << r.p90Ms
+					<< ", \"p99Ms\": " << r.p99Ms
+					<< ", \"ciLowMs\": " << r.ciLowMs
+					<< ", \"ciHighMs\": " << r.ciHighMs
+					<< ", \"throughput\": " << r.throughput
+					<< ", \"threadMedianMs\": " << r.threadMedianMs
+					<< ", \"threadP99Ms\": " << r.threadP99Ms
+					<< ", \"nsPerOp\": " << r.nsPerOp
+					<< ", \"nsPerElement\": " << r.nsPerElement
+					<< ", \"allocations\": " << r.allocations
+					<< ", \"allocatedBytes\": " << r.allocatedBytes
+					<< ", \"peakLiveBytes\": " << r.peakLiveBytes
+					<< ", \"peakRssBytes\": " << r.peakRssBytes;
+
+				if (r.counters)
+				{
+					auto const& c{ *r.counters };
+					out << ", \"counters\": { \"cycles\": " << c.cycles
+						<< ", \"instructions\": " << c.instructions
+						<< ", \"l1dMisses\": " << c.l1dMisses
+						<< ", \"llcMisses\": " << c.llcMisses
+						<< ", \"dtlbMisses\": " << c.dtlbMisses
+						<< ", \"branchMisses\": " << c.branchMisses << " }";
+				}
+
+				out << ", \"samplesNs\": [";
+				for (size_t j{ 0 }; j < r.samplesNs.size(); ++j)
+				{
+					out << (j == 0 ? "" : ", ") << r.samplesNs[j];
+				}
+				out << "]";
+
+				if (!r.metrics.empty())
+				{
+					out << ", \"metrics\": {";
+					for (size_t j{ 0 }; j < r.metrics.size(); ++j)
+					{
+						out << (j == 0 ? " " : ", ") << quoted(r.metrics[j].first) << ": " << r.metrics[j].second;
+					}
+					out << " }";
+				}
+				out << " }";
 			}
+			out << "\n  ]\n}\n";
 
 			std::cout << "\nResults written to: " << filePath << "\n";
 			return true;
 		}
 
+		static void PrintResults(std::ostream& out, std::vector<BenchmarkResult> const& results) noexcept
+		{
+			auto const flags{ out.flags() };
+			out << std::fixed << std::setprecision(3);
+
+			out << std::left << std::setw(44) << "Benchmark" << std::setw(20) << "Category"
+				<< std::right << std::setw(12) << "Size" << std::setw(8) << "Threads"
+				<< std::setw(16) << "Median(Ms)" << std::setw(18) << "Ns/Op" << std::setw(12) << "Ns/Element" << "\n";
+
+			for (auto const& r : results)
+			{
+				out << std::left << std::setw(44) << r.name << std::setw(20) << r.category
+					<< std::right << std::setw(12) << r.size << std::setw(8) << r.threads
+					<< std::setw(16) << r.medianMs << std::setw(18) << r.nsPerOp << std::setw(12) << r.nsPerElement << "\n";
+
+				if (!r.metrics.empty())
+				{
+					out << "    ";
+					for (auto const& [name, value] : r.metrics)
+					{
+						out << ' ' << name << '=' << value;
+					}
+					out << "\n";
+				}
+			}
+
+			out.flags(flags);
+		}
+
 		static bool AppendToMasterResults(std::filesystem::path const& mergedFile, std::string const& compilerInfo, std::vector<BenchmarkResult> const& results) noexcept
 		{
 			std::vector<std::string> oldLines;
 			if (std::filesystem::exists(mergedFile))
 			{
 				std::ifstream in(mergedFile);
-				std::string line;
-				int skip{ 0 };
-				while (std::getline(in, line))
+				std::string date;
+				std::string header;
+				std::getline(in, date);
+				std::getline(in, header);
+
+				if (header == CSV_HEADER)
 				{
-					if (skip != 2)
+					std::string line;
+					while (std::getline(in, line))
 					{
-						++skip;
-						continue;
+						oldLines.emplace_back(line);
 					}
+				}
+				else
+				{
+					// Rows written with other columns would end up under the wrong names, so the old file is kept
+					// next to the new one, named after its date row
+					in.close();
+					std::string suffix{ date.starts_with("Date:,") ? date.substr(6) : "old" };
+					std::replace(suffix.begin(), suffix.end(), ' ', '_');
+					std::replace(suffix.begin(), suffix.end(), ':', '-');
 
-					oldLines.emplace_back(line);
+					std::filesystem::path oldFile{ mergedFile };
+					oldFile.replace_filename(mergedFile.stem().string() + "_" + suffix + mergedFile.extension().string());
+
+					std::error_code error;
+					std::filesystem::rename(mergedFile, oldFile, error);
+					if (error)
+					{
+						std::cerr << "Error: could not move " << mergedFile << " with an older column layout to " << oldFile << "\n";
+						return false;
+					}
+					std::cout << "Columns changed, moved the previous results to: " << oldFile << "\n";
 				}
 			}
 
 			for (auto const& r : results)
 			{
 				std::ostringstream oss;
-				oss << compilerInfo << ','
-					<< r.name << ','
-					<< r.category << ','
-					<< r.iterations << ','
-					<< r.avgMs << ','
-					<< r.totalMs << ','
-					<< r.medianMs << ','
-					<< r.minMs << ','
-					<< r.maxMs;
+				oss.imbue(std::locale::classic());
+				oss << std::fixed << std::setprecision(6);
+				WriteCsvRow(oss, compilerInfo, r);
 
 				oldLines.emplace_back(oss.str());
 			}
@@ -191,7 +619,7 @@ namespace Mau
 			// Write date row
 			merged << "Date:," << timeBuf << "\n";
 
-			merged << "Compiler,Benchmark,Category,Iterations,Average(Ms),Total(Ms),Median(Ms),Min(Ms),Max(Ms)\n";
+			merged << CSV_HEADER << "\n";
 			for (auto const& line : oldLines)
 			{
 				merged << line << "\n";
@@ -207,45 +635,549 @@ namespace Mau
 		BenchmarkRegistry() = default;
 		virtual ~BenchmarkRegistry() override = default;
 
+		struct BenchmarkInstance final
+		{
+			BenchmarkFunc setup;
+			BenchmarkFunc func;
+			BenchmarkFunc teardown;
+			std::function<BenchmarkMetrics()> metrics;
+		};
+
+		// Receives the size point (0 for benchmarks without a size axis) and the thread count
+		using BenchmarkFactory = std::function<BenchmarkInstance(size_t, size_t)>;
+
 		struct BenchmarkEntry final
 		{
 			std::string name;
 			std::string category;
 
-			BenchmarkFunc func;
+			BenchmarkFactory factory;
 			size_t iterations;
+
+			bool threaded{ false };
+			bool sized{ false };
+			bool batched{ false };
+
+			// Points of the size axis above this are skipped, for benchmarks that scale too badly to run on the full sweep
+			size_t maxSize{ std::numeric_limits<size_t>::max() };
+
+			// func starts its own workers (WorkerState), the thread axis is not used to run it on several threads
+			bool workers{ false };
 		};
 
+		[[nodiscard]] static bool Matches(BenchmarkFilter const& filter, BenchmarkEntry const& entry) noexcept
+		{
+			return (!filter.name || std::regex_search(entry.name, *filter.name))
+				&& (!filter.category || std::regex_search(entry.category, *filter.category));
+		}
+
+		// Binds the fixture hooks to a state object that lives as long as the returned instance
+		template <typename State>
+		[[nodiscard]] static BenchmarkFactory MakeFixtureFactory(FixtureFunc<State> const& setup, FixtureFunc<State> const& func, FixtureFunc<State> const& teardown) noexcept
+		{
+			return [setup, func, teardown](size_t size, size_t threads)
+				{
+					auto const state{ std::make_shared<State>() };
+					if constexpr (SizedState<State>)
+					{
+						state->size = size;
+					}
+					if constexpr (WorkerState<State>)
+					{
+						state->threads = threads;
+					}
+
+					BenchmarkInstance instance{};
+					if (setup)
+					{
+						instance.setup = [setup, state]() { setup(*state); };
+					}
+					instance.func = [func, state]() { func(*state); };
+					if (teardown)
+					{
+						instance.teardown = [teardown, state]() { teardown(*state); };
+					}
+					if constexpr (MetricState<State>)
+					{
+						instance.metrics = [state]() { return state->metrics; };
+					}
+
+					return instance;
+				};
+		}
+
 		std::vector<BenchmarkEntry> m_Benchmarks;
+		BenchmarkConfig m_Config{};
+
+		static constexpr char const* CSV_HEADER{ "Compiler,Benchmark,Category,Size,Threads,Iterations,Batch,Average(Ms),Total(Ms),Median(Ms),Min(Ms),Max(Ms),"
+			"StdDev(Ms),MAD(Ms),P90(Ms),P99(Ms),CI Low(Ms),CI High(Ms),"
+			"Throughput(Ops/s),Thread Median(Ms),Thread P99(Ms),Ns/Op,Ns/Element,"
+			"Allocations,Allocated Bytes,Peak Live Bytes,Peak RSS Bytes,"
+			"Cycles,Instructions,L1D Misses,LLC Misses,DTLB Misses,Branch Misses,Samples(Ns),Metrics" };
+
+		static void WriteCsvRow(std::ostream& out, std::string const& compilerInfo, BenchmarkResult const& r) noexcept
+		{
+			out << compilerInfo << ','
+				<< r.name << ','
+				<< r.category << ','
+				<< r.size << ','
+				<< r.threads << ','
+				<< r.iterations << ','
+				<< r.batch << ','
+				<< r.avgMs << ','
+				<< r.totalMs << ','
+				<< r.medianMs << ','
+				<< r.minMs << ','
+				<< r.maxMs << ','
+				<< r.stddevMs << ','
+				<< r.madMs << ','
+				<< r.p90Ms << ','
+				<< r.p99Ms << ','
+				<< r.ciLowMs << ','
+				<< r.ciHighMs << ','
+				<< r.throughput << ','
+				<< r.threadMedianMs << ','
+				<< r.threadP99Ms << ','
+				<< r.nsPerOp << ','
+				<< r.nsPerElement << ','
+				<< r.allocations << ','
+				<< r.allocatedBytes << ','
+				<< r.peakLiveBytes << ','
+				<< r.peakRssBytes;
+
+			// Counter columns stay empty when they were not measured
+			auto writeCounter
+			{
+				[&out](std::optional<PerfCounterValues> const& counters, double PerfCounterValues::* field)
+				{
+					out << ',';
+					if (counters && (*counters).*field >= 0.0)
+					{
+						out << (*counters).*field;
+					}
+				}
+			};
+
+			writeCounter(r.counters, &PerfCounterValues::cycles);
+			writeCounter(r.counters, &PerfCounterValues::instructions);
+			writeCounter(r.counters, &PerfCounterValues::l1dMisses);
+			writeCounter(r.counters, &PerfCounterValues::llcMisses);
+			writeCounter(r.counters, &PerfCounterValues::dtlbMisses);
+			writeCounter(r.counters, &PerfCounterValues::branchMisses);
+
+			// Semicolon separated, so the raw samples fit in a single CSV cell
+			auto const precision{ out.precision(3) };
+			out << ',';
+			for (size_t i{ 0 }; i < r.samplesNs.size(); ++i)
+			{
+				out << (i == 0 ? "" : ";") << r.samplesNs[i];
+			}
+			out.precision(precision);
+
+			out << ',';
+			for (size_t i{ 0 }; i < r.metrics.size(); ++i)
+			{
+				out << (i == 0 ? "" : ";") << r.metrics[i].first << '=' << r.metrics[i].second;
+			}
+		}
+
+
+		// Everything except name and category, which the parent already knows, as text with round-trip precision
+		[[nodiscard]] static std::string SerializeResult(BenchmarkResult const& r) noexcept
+		{
+			std::ostringstream out;
+			out.imbue(std::locale::classic());
+			out << std::setprecision(std::numeric_limits<double>::max_digits10);
 
+			out << r.size << ' ' << r.threads << ' ' << r.iterations << ' ' << r.batch << ' '
+				<< r.avgMs << ' ' << r.totalMs << ' ' << r.medianMs << ' ' << r.minMs << ' ' << r.maxMs << ' '
+				<< r.stddevMs << ' ' << r.madMs << ' ' << r.p90Ms << ' ' << r.p99Ms << ' ' << r.ciLowMs << ' ' << r.ciHighMs << ' '
+				<< r.throughput << ' ' << r.threadMedianMs << ' ' << r.threadP99Ms << ' ' << r.nsPerOp << ' ' << r.nsPerElement << ' '
+				<< r.allocations << ' ' << r.allocatedBytes << ' ' << r.peakLiveBytes << ' ' << r.peakRssBytes << ' '
+				<< (r.counters ? 1 : 0);
 
-		static BenchmarkResult RunBenchmark(BenchmarkEntry const& entry) noexcept
+			if (r.counters)
+			{
+				auto const& c{ *r.counters };
+				out << ' ' << c.cycles << ' ' << c.instructions << ' ' << c.l1dMisses << ' ' << c.llcMisses << ' ' << c.dtlbMisses << ' ' << c.branchMisses;
+			}
+
+			out << ' ' << r.samplesNs.size();
+			for (double const sample : r.samplesNs)
+			{
+				out << ' ' << sample;
+			}
+
+			out << ' ' << r.metrics.size();
+			for (auto const& [name, value] : r.metrics)
+			{
+				out << ' ' << name << ' ' << value;
+			}
+			return out.str();
+		}
+
+		[[nodiscard]] static std::optional<BenchmarkResult> DeserializeResult(std::string const& text) noexcept
+		{
+			std::istringstream in{ text };
+			in.imbue(std::locale::classic());
+
+			BenchmarkResult r{};
+			int hasCounters{};
+			in >> r.size >> r.threads >> r.iterations >> r.batch
+				>> r.avgMs >> r.totalMs >> r.medianMs >> r.minMs >> r.maxMs
+				>> r.stddevMs >> r.madMs >> r.p90Ms >> r.p99Ms >> r.ciLowMs >> r.ciHighMs
+				>> r.throughput >> r.threadMedianMs >> r.threadP99Ms >> r.nsPerOp >> r.nsPerElement
+				>> r.allocations >> r.allocatedBytes >> r.peakLiveBytes >> r.peakRssBytes
+				>> hasCounters;
+
+			if (hasCounters)
+			{
+				PerfCounterValues c{};
+				in >> c.cycles >> c.instructions >> c.l1dMisses >> c.llcMisses >> c.dtlbMisses >> c.branchMisses;
+				r.counters = c;
+			}
+
+			size_t sampleCount{};
+			in >> sampleCount;
+			for (size_t i{ 0 }; i < sampleCount && in; ++i)
+			{
+				in >> r.samplesNs.emplace_back();
+			}
+
+			size_t metricCount{};
+			in >> metricCount;
+			for (size_t i{ 0 }; i < metricCount && in; ++i)
+			{
+				auto& [name, value]{ r.metrics.emplace_back() };
+				in >> name >> value;
+			}
+
+			if (in.fail())
+			{
+				return std::nullopt;
+			}
+			return r;
+		}
+
+		static BenchmarkResult RunBenchmark(BenchmarkEntry const& entry, BenchmarkConfig const& config, size_t size, size_t threads) noexcept
 		{
 			using namespace std::chrono;
 
 			std::vector<double> times;
-			times.reserve(entry.iterations);
+			size_t const fixedIterations{ config.iterations.value_or(entry.iterations) };
+			times.reserve(config.adaptive ? config.minIterations : fixedIterations);
+
+			// Latency of every individual thread's call, only filled for multithreaded runs
+			std::vector<double> threadTimes;
+
+			BenchmarkInstance const instance{ entry.factory(size, threads) };
+
+			// Threads that run func concurrently, a worker benchmark's func is called once and starts its own threads
+			size_t const callers{ entry.workers ? 1 : threads };
 
-			for (size_t i{ 0 }; i < entry.iterations; ++i)
+			// The counter group only follows the calling thread, so it is not used for multithreaded runs
+			std::optional<PerfCounterGroup> perf;
+			if (config.perfCounters && threads == 1)
 			{
-				auto const start{ high_resolution_clock::now() };
+				perf.emplace();
+			}
+			bool countersValid{ perf && perf->IsAvailable() };
+			PerfCounterValues counterSum{ 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+
+			uint64_t allocCount{ 0 };
+			uint64_t allocBytes{ 0 };
+			int64_t peakLive{ 0 };
 
-				entry.func();
+			size_t batch{ 1 };
+			double overheadNs{ CycleClock::GetInstance().OverheadNs() };
+			if (entry.batched)
+			{
+				batch = CalibrateBatch(instance, config.minBatchTimeUs * 1'000.0);
 
-				auto const end{ high_resolution_clock::now() };
+				// Calling through the fixture wrappers is overhead as well, measure it on an empty fixture body
+				struct EmptyState final {};
+				BenchmarkInstance const empty{ MakeFixtureFactory<EmptyState>(nullptr, [](EmptyState&) {}, nullptr)(0, 1) };
 
-				auto const dur{ duration<double, std::milli>(end - start).count() };
-				times.emplace_back(dur);
+				double emptyNs{ std::numeric_limits<double>::max() };
+				for (int i{ 0 }; i < 10; ++i)
+				{
+					emptyNs = std::min(emptyNs, TimeBatch(empty.func, batch, 0.0));
+				}
+				overheadNs = emptyNs;
 			}
 
+			auto runIteration
+			{
+				[&](bool record)
+				{
+					if (instance.setup)
+					{
+						instance.setup();
+					}
+
+					auto const allocBefore{ AllocTracker::Take() };
+					AllocTracker::ResetPeak();
+
+					if (record && countersValid)
+					{
+						perf->Start();
+					}
+
+					double durationMs{};
+					if (callers == 1)
+					{
+						durationMs = TimeBatch(instance.func, batch, overheadNs) / 1'000'000.0;
+					}
+					else
+					{
+						durationMs = RunParallel(instance.func, callers, record ? &threadTimes : nullptr);
+					}
+
+					if (record && countersValid)
+					{
+						perf->Stop();
+
+						PerfCounterValues values{};
+						countersValid = perf->Read(values);
+						AccumulateCounters(counterSum, values);
+					}
+
+					if (record)
+					{
+						auto const allocAfter{ AllocTracker::Take() };
+						allocCount += allocAfter.count - allocBefore.count;
+						allocBytes += allocAfter.bytes - allocBefore.bytes;
+						peakLive = std::max(peakLive, AllocTracker::PeakLiveBytes() - allocBefore.liveBytes);
+					}
+
+					if (instance.teardown)
+					{
+						instance.teardown();
+					}
+
+					if (record)
+					{
+						times.emplace_back(durationMs / static_cast<double>(batch));
+					}
+				}
+			};
+
+			for (size_t i{ 0 }; i < config.warmupIterations; ++i)
+			{
+				runIteration(false);
+			}
+
+			if (config.adaptive)
+			{
+				// Keep sampling until the mean is stable enough or the time budget is spent
+				auto const budgetStart{ steady_clock::now() };
+				while (times.size() < config.maxIterations)
+				{
+					runIteration(true);
+
+					if (times.size() < config.minIterations)
+					{
+						continue;
+					}
+
+					double const elapsedMs{ duration<double, std::milli>(steady_clock::now() - budgetStart).count() };
+					if (elapsedMs >= config.targetTimeMs || RelativeStandardError(times) <= config.rseThreshold)
+					{
+						break;
+					}
+				}
+			}
+			else
+			{
+				for (size_t i{ 0 }; i < fixedIterations; ++i)
+				{
+					runIteration(true);
+				}
+			}
+
+			size_t const iterations{ times.size() };
+
+			BenchmarkResult result{};
+			result.name = entry.name;
+			result.category = entry.category;
+			result.size = size;
+			result.threads = threads;
+			result.iterations = iterations;
+			result.batch = batch;
+
+			result.stddevMs = StdDev(times);
+			auto const ci{ BootstrapMedianCI(times) };
+			result.ciLowMs = ci.lower;
+			result.ciHighMs = ci.upper;
+
 			std::sort(times.begin(), times.end());
-			double const total{ std::accumulate(times.begin(), times.end(), 0.0) };
-			double const avg{ total / entry.iterations };
-			double const median{ times[times.size() / 2] };
-			double const min{ times.front() };
-			double const max{ times.back() };
+			result.totalMs = std::accumulate(times.begin(), times.end(), 0.0);
+			result.avgMs = result.totalMs / iterations;
+			result.medianMs = times[times.size() / 2];
+			result.minMs = times.front();
+			result.maxMs = times.back();
+			result.madMs = MedianAbsoluteDeviation(times);
+			result.p90Ms = Percentile(times, 0.90);
+			result.p99Ms = Percentile(times, 0.99);
+
+			result.throughput = static_cast<double>(callers * iterations) / (result.totalMs / 1000.0);
+			if (threadTimes.empty())
+			{
+				result.threadMedianMs = result.medianMs;
+				result.threadP99Ms = result.p99Ms;
+			}
+			else
+			{
+				std::sort(threadTimes.begin(), threadTimes.end());
+				result.threadMedianMs = Percentile(threadTimes, 0.5);
+				result.threadP99Ms = Percentile(threadTimes, 0.99);
+			}
+
+			result.nsPerOp = result.threadMedianMs * 1'000'000.0;
+			result.nsPerElement = (size == 0 || entry.batched) ? 0.0 : result.nsPerOp / static_cast<double>(size);
+
+			double const calls{ static_cast<double>(iterations * batch) };
+			result.allocations = static_cast<double>(allocCount) / calls;
+			result.allocatedBytes = static_cast<double>(allocBytes) / calls;
+			result.peakLiveBytes = static_cast<double>(peakLive);
+			result.peakRssBytes = static_cast<double>(GetPeakRssBytes());
+
+			if (countersValid)
+			{
+				result.counters = AverageCounters(counterSum, iterations * batch);
+			}
+
+			result.samplesNs.reserve(times.size());
+			for (double const t : times)
+			{
+				result.samplesNs.emplace_back(t * 1'000'000.0);
+			}
+
+			if (instance.metrics)
+			{
+				result.metrics = instance.metrics();
+			}
+
+			return result;
+		}
+
+		// Runs func batch times between two timestamps, returns the elapsed time minus overheadNs (never negative)
+		static double TimeBatch(BenchmarkFunc const& func, size_t batch, double overheadNs) noexcept
+		{
+			auto const& clock{ CycleClock::GetInstance() };
+
+			uint64_t const start{ clock.Now() };
+
+			for (size_t i{ 0 }; i < batch; ++i)
+			{
+				func();
+			}
+
+			uint64_t const end{ clock.NowEnd() };
+
+			return std::max(0.0, clock.ToNs(end - start) - overheadNs);
+		}
+
+		// Doubles the batch size until one batch of func takes at least targetNs
+		static size_t CalibrateBatch(BenchmarkInstance const& instance, double targetNs) noexcept
+		{
+			size_t constexpr MAX_BATCH{ size_t{ 1 } << 30 };
+
+			size_t batch{ 1 };
+			while (batch < MAX_BATCH)
+			{
+				if (instance.setup)
+				{
+					instance.setup();
+				}
+
+				double const elapsedNs{ TimeBatch(instance.func, batch, 0.0) };
+
+				if (instance.teardown)
+				{
+					instance.teardown();
+				}
+
+				if (elapsedNs >= targetNs)
+				{
+					break;
+				}
+				batch *= 2;
+			}
+			return batch;
+		}
+
+		// Releases all threads at once through a barrier so thread start-up is not part of the measurement.
+		// Returns the wall time from the first thread starting to the last one finishing.
+		static double RunParallel(BenchmarkFunc const& func, size_t threads, std::vector<double>* threadTimes) noexcept
+		{
+			auto const& clock{ CycleClock::GetInstance() };
+
+			std::vector<uint64_t> starts(threads);
+			std::vector<uint64_t> ends(threads);
+			std::barrier sync{ static_cast<ptrdiff_t>(threads) };
+
+			{
+				std::vector<std::jthread> workers;
+				workers.reserve(threads);
+				for (size_t t{ 0 }; t < threads; ++t)
+				{
+					workers.emplace_back([&, t]()
+						{
+							sync.arrive_and_wait();
+							starts[t] = clock.Now();
+
+							func();
+
+							ends[t] = clock.NowEnd();
+						});
+				}
+			}
+
+			if (threadTimes)
+			{
+				for (size_t t{ 0 }; t < threads; ++t)
+				{
+					threadTimes->emplace_back(clock.ToNs(ends[t] - starts[t]) / 1'000'000.0);
+				}
+			}
+
+			uint64_t const first{ *std::min_element(starts.begin(), starts.end()) };
+			uint64_t const last{ *std::max_element(ends.begin(), ends.end()) };
+			return clock.ToNs(last - first) / 1'000'000.0;
+		}
+
+		// An event that could not be counted in any iteration stays negative (unavailable)
+		static void AccumulateCounters(PerfCounterValues& sum, PerfCounterValues const& values) noexcept
+		{
+			auto accumulate
+			{
+				[](double& total, double value)
+				{
+					total = (total < 0.0 || value < 0.0) ? -1.0 : total + value;
+				}
+			};
+
+			accumulate(sum.cycles, values.cycles);
+			accumulate(sum.instructions, values.instructions);
+			accumulate(sum.l1dMisses, values.l1dMisses);
+			accumulate(sum.llcMisses, values.llcMisses);
+			accumulate(sum.dtlbMisses, values.dtlbMisses);
+			accumulate(sum.branchMisses, values.branchMisses);
+		}
+
+		[[nodiscard]] static PerfCounterValues AverageCounters(PerfCounterValues const& sum, size_t iterations) noexcept
+		{
+			auto average
+			{
+				[iterations](double total)
+				{
+					return total < 0.0 ? -1.0 : total / static_cast<double>(iterations);
+				}
+			};
 
-			return { entry.name, entry.category, entry.iterations, avg, total, median, min, max };
+			return { average(sum.cycles), average(sum.instructions), average(sum.l1dMisses),
+				average(sum.llcMisses), average(sum.dtlbMisses), average(sum.branchMisses) };
 		}
 	};
 
@@ -0,0 +1,243 @@
+#ifndef MAU_BENCHMARK_COMPARE_H
+#define MAU_BENCHMARK_COMPARE_H
+
+#include "benchmark.h"
+#include "benchmark_stats.h"
+
+#include <algorithm>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+namespace Mau
+{
+	struct CompareConfig final
+	{
+		// Relative change of the median that counts as a real difference (0.05 = 5%)
+		double threshold{ 0.05 };
+		// Significance level of the Mann-Whitney test, only used when both runs stored their samples
+		double alpha{ 0.01 };
+	};
+
+	struct BaselineResult final
+	{
+		std::string name;
+		std::string category;
+		size_t size;
+		size_t threads;
+		double medianNs;
+		std::vector<double> samplesNs;
+	};
+
+	[[nodiscard]] static std::vector<std::string_view> SplitCsvLine(std::string_view line, char separator = ',') noexcept
+	{
+		std::vector<std::string_view> fields;
+		while (true)
+		{
+			size_t const end{ line.find(separator) };
+			fields.emplace_back(line.substr(0, end));
+			if (end == std::string_view::npos)
+			{
+				break;
+			}
+			line.remove_prefix(end + 1);
+		}
+		return fields;
+	}
+
+	// Reads a file written by WriteCsv or AppendToMasterResults. Columns are looked up by header name,
+	// so files from older versions without Threads or Samples columns still load.
+	// When a benchmark point appears more than once (master results), the last row wins.
+	[[nodiscard]] static std::optional<std::vector<BaselineResult>> LoadBaseline(std::filesystem::path const& filePath) noexcept
+	{
+		std::ifstream in(filePath);
+		if (!in.is_open())
+		{
+			std::cerr << "Error: could not open baseline " << filePath << "\n";
+			return std::nullopt;
+		}
+
+		std::vector<std::string> header;
+		std::string line;
+		while (std::getline(in, line))
+		{
+			if (line.starts_with("Compiler,"))
+			{
+				for (auto const field : SplitCsvLine(line))
+				{
+					header.emplace_back(field);
+				}
+				break;
+			}
+		}
+
+		auto column
+		{
+			[&header](std::string_view name) -> std::optional<size_t>
+			{
+				auto const it{ std::find(header.begin(), header.end(), name) };
+				if (it == header.end())
+				{
+					return std::nullopt;
+				}
+				return static_cast<size_t>(it - header.begin());
+			}
+		};
+
+		auto const nameCol{ column("Benchmark") };
+		auto const categoryCol{ column("Category") };
+		auto const medianCol{ column("Median(Ms)") };
+		auto const sizeCol{ column("Size") };
+		auto const threadsCol{ column("Threads") };
+		auto const samplesCol{ column("Samples(Ns)") };
+		if (!nameCol || !categoryCol || !medianCol)
+		{
+			std::cerr << "Error: " << filePath << " is not a benchmark results file\n";
+			return std::nullopt;
+		}
+
+		auto parseDouble
+		{
+			[](std::string_view text, double& value)
+			{
+				return std::from_chars(text.data(), text.data() + text.size(), value).ec == std::errc{};
+			}
+		};
+
+		std::map<std::tuple<std::string, std::string, size_t, size_t>, BaselineResult> byKey;
+		while (std::getline(in, line))
+		{
+			auto const fields{ SplitCsvLine(line) };
+			if (fields.size() < header.size() || line.starts_with("Compiler,"))
+			{
+				continue;
+			}
+
+			BaselineResult r{};
+			r.name = fields[*nameCol];
+			r.category = fields[*categoryCol];
+			r.threads = 1;
+
+			double medianMs{};
+			if (!parseDouble(fields[*medianCol], medianMs))
+			{
+				continue;
+			}
+			r.medianNs = medianMs * 1'000'000.0;
+
+			if (sizeCol)
+			{
+				std::from_chars(fields[*sizeCol].data(), fields[*sizeCol].data() + fields[*sizeCol].size(), r.size);
+			}
+			if (threadsCol)
+			{
+				std::from_chars(fields[*threadsCol].data(), fields[*threadsCol].data() + fields[*threadsCol].size(), r.threads);
+			}
+			if (samplesCol && !fields[*samplesCol].empty())
+			{
+				for (auto const sample : SplitCsvLine(fields[*samplesCol], ';'))
+				{
+					if (!parseDouble(sample, r.samplesNs.emplace_back()))
+					{
+						r.samplesNs.pop_back();
+					}
+				}
+				std::sort(r.samplesNs.begin(), r.samplesNs.end());
+				r.medianNs = Percentile(r.samplesNs, 0.5);
+			}
+
+			auto key{ std::make_tuple(r.name, r.category, r.size, r.threads) };
+			byKey.insert_or_assign(std::move(key), std::move(r));
+		}
+
+		std::vector<BaselineResult> baseline;
+		baseline.reserve(byKey.size());
+		for (auto& [key, r] : byKey)
+		{
+			baseline.emplace_back(std::move(r));
+		}
+		return baseline;
+	}
+
+	// Prints one row per benchmark point found in both runs and returns true when any of them regressed:
+	// slower by more than the threshold, and (when samples are available on both sides) significantly so
+	[[nodiscard]] static bool CompareToBaseline(std::ostream& out, std::vector<BenchmarkRegistry::BenchmarkResult> const& results, std::vector<BaselineResult> const& baseline, CompareConfig const& config) noexcept
+	{
+		auto const flags{ out.flags() };
+		auto const precision{ out.precision() };
+
+		out << "\nComparison against baseline (threshold " << config.threshold * 100.0 << "%, alpha " << config.alpha << ")\n";
+		out << std::left << std::setw(36) << "Benchmark" << std::setw(20) << "Category"
+			<< std::right << std::setw(12) << "Size" << std::setw(8) << "Threads"
+			<< std::setw(16) << "Baseline(Ns)" << std::setw(16) << "Current(Ns)" << std::setw(10) << "Speedup"
+			<< std::setw(10) << "p" << "  Verdict\n";
+
+		size_t matched{ 0 };
+		size_t regressions{ 0 };
+		for (auto const& r : results)
+		{
+			auto const it
+			{
+				std::find_if(baseline.begin(), baseline.end(), [&r](BaselineResult const& b)
+				{
+					return b.name == r.name && b.category == r.category && b.size == r.size && b.threads == r.threads;
+				})
+			};
+			if (it == baseline.end())
+			{
+				continue;
+			}
+			++matched;
+
+			double const currentNs{ r.samplesNs.empty() ? r.medianMs * 1'000'000.0 : Percentile(r.samplesNs, 0.5) };
+			double const baselineNs{ it->medianNs };
+			double const speedup{ currentNs > 0.0 ? baselineNs / currentNs : 1.0 };
+
+			bool const haveSamples{ !r.samplesNs.empty() && !it->samplesNs.empty() };
+			double const p{ haveSamples ? MannWhitneyPValue(r.samplesNs, it->samplesNs) : 0.0 };
+			bool const significant{ !haveSamples || p < config.alpha };
+
+			char const* verdict{ "same" };
+			if (significant && currentNs > baselineNs * (1.0 + config.threshold))
+			{
+				verdict = "REGRESSION";
+				++regressions;
+			}
+			else if (significant && currentNs < baselineNs * (1.0 - config.threshold))
+			{
+				verdict = "faster";
+			}
+
+			out << std::left << std::setw(36) << r.name << std::setw(20) << r.category
+				<< std::right << std::setw(12) << r.size << std::setw(8) << r.threads
+				<< std::fixed << std::setprecision(2) << std::setw(16) << baselineNs << std::setw(16) << currentNs
+				<< std::setprecision(3) << std::setw(9) << speedup << 'x';
+
+			if (haveSamples)
+			{
+				out << std::setprecision(4) << std::setw(10) << p;
+			}
+			else
+			{
+				out << std::setw(10) << "-";
+			}
+			out << "  " << verdict << "\n";
+		}
+
+		out << matched << " of " << results.size() << " results matched the baseline, " << regressions << " regression(s)\n";
+
+		out.flags(flags);
+		out.precision(precision);
+		return regressions > 0;
+	}
+}
+
+#endif
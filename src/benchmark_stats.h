@@ -0,0 +1,194 @@
+#ifndef MAU_BENCHMARK_STATS_H
+#define MAU_BENCHMARK_STATS_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace Mau
+{
+	struct ConfidenceInterval final
+	{
+		double lower;
+		double upper;
+	};
+
+	[[nodiscard]] static double Mean(std::vector<double> const& samples) noexcept
+	{
+		if (samples.empty())
+		{
+			return 0.0;
+		}
+		return std::accumulate(samples.begin(), samples.end(), 0.0) / static_cast<double>(samples.size());
+	}
+
+	// Sample standard deviation (Bessel corrected)
+	[[nodiscard]] static double StdDev(std::vector<double> const& samples) noexcept
+	{
+		if (samples.size() < 2)
+		{
+			return 0.0;
+		}
+
+		double const mean{ Mean(samples) };
+		double sumSq{ 0.0 };
+		for (double const s : samples)
+		{
+			sumSq += (s - mean) * (s - mean);
+		}
+		return std::sqrt(sumSq / static_cast<double>(samples.size() - 1));
+	}
+
+	// Linear interpolation between closest ranks, p in [0, 1]; expects sorted samples
+	[[nodiscard]] static double Percentile(std::vector<double> const& sorted, double p) noexcept
+	{
+		if (sorted.empty())
+		{
+			return 0.0;
+		}
+
+		double const rank{ p * static_cast<double>(sorted.size() - 1) };
+		size_t const lo{ static_cast<size_t>(rank) };
+		size_t const hi{ std::min(lo + 1, sorted.size() - 1) };
+		double const frac{ rank - static_cast<double>(lo) };
+		return sorted[lo] + (sorted[hi] - sorted[lo]) * frac;
+	}
+
+	// Median absolute deviation; expects sorted samples
+	[[nodiscard]] static double MedianAbsoluteDeviation(std::vector<double> const& sorted) noexcept
+	{
+		if (sorted.empty())
+		{
+			return 0.0;
+		}
+
+		double const median{ Percentile(sorted, 0.5) };
+		std::vector<double> deviations;
+		deviations.reserve(sorted.size());
+		for (double const s : sorted)
+		{
+			deviations.emplace_back(std::abs(s - median));
+		}
+		std::sort(deviations.begin(), deviations.end());
+		return Percentile(deviations, 0.5);
+	}
+
+	// Relative standard error: the standard error of the mean divided by the mean.
+	// Unlike the coefficient of variation of the samples this shrinks as samples are added, so it can be used as a convergence criterion.
+	[[nodiscard]] static double RelativeStandardError(std::vector<double> const& samples) noexcept
+	{
+		double const mean{ Mean(samples) };
+		if (samples.size() < 2 || mean <= 0.0)
+		{
+			return std::numeric_limits<double>::infinity();
+		}
+		return StdDev(samples) / std::sqrt(static_cast<double>(samples.size())) / mean;
+	}
+
+	// Percentile bootstrap confidence interval of the median.
+	// Fixed seed so repeated reports over the same samples are identical.
+	[[nodiscard]] static ConfidenceInterval BootstrapMedianCI(std::vector<double> const& samples, double confidence = 0.95, size_t resamples = 1000) noexcept
+	{
+		if (samples.size() < 2)
+		{
+			double const v{ samples.empty() ? 0.0 : samples.front() };
+			return { v, v };
+		}
+
+		std::mt19937_64 rng{ 0x9E3779B97F4A7C15ull };
+		std::uniform_int_distribution<size_t> pick{ 0, samples.size() - 1 };
+
+		std::vector<double> medians;
+		medians.reserve(resamples);
+		std::vector<double> resample(samples.size());
+
+		for (size_t r{ 0 }; r < resamples; ++r)
+		{
+			for (double& s : resample)
+			{
+				s = samples[pick(rng)];
+			}
+			auto const mid{ resample.begin() + static_cast<ptrdiff_t>(resample.size() / 2) };
+			std::nth_element(resample.begin(), mid, resample.end());
+			medians.emplace_back(*mid);
+		}
+
+		std::sort(medians.begin(), medians.end());
+		double const alpha{ (1.0 - confidence) / 2.0 };
+		return { Percentile(medians, alpha), Percentile(medians, 1.0 - alpha) };
+	}
+
+	// Two-sided Mann-Whitney U test: probability of seeing rank sums at least this different if both sample sets
+	// come from the same distribution. Normal approximation with tie and continuity correction, so it needs
+	// roughly 8+ samples per side to be meaningful. Makes no assumption about the shape of the distributions.
+	[[nodiscard]] static double MannWhitneyPValue(std::vector<double> const& a, std::vector<double> const& b) noexcept
+	{
+		if (a.empty() || b.empty())
+		{
+			return 1.0;
+		}
+
+		struct Ranked final
+		{
+			double value;
+			bool fromA;
+		};
+
+		std::vector<Ranked> all;
+		all.reserve(a.size() + b.size());
+		for (double const v : a)
+		{
+			all.emplace_back(v, true);
+		}
+		for (double const v : b)
+		{
+			all.emplace_back(v, false);
+		}
+		std::sort(all.begin(), all.end(), [](Ranked const& l, Ranked const& r) { return l.value < r.value; });
+
+		// Tied values share the average of their ranks
+		double rankSumA{ 0.0 };
+		double tieTerm{ 0.0 };
+		for (size_t i{ 0 }; i < all.size();)
+		{
+			size_t j{ i };
+			while (j < all.size() && all[j].value == all[i].value)
+			{
+				++j;
+			}
+
+			double const ties{ static_cast<double>(j - i) };
+			double const rank{ (static_cast<double>(i + 1) + static_cast<double>(j)) / 2.0 };
+			for (size_t k{ i }; k < j; ++k)
+			{
+				if (all[k].fromA)
+				{
+					rankSumA += rank;
+				}
+			}
+			tieTerm += ties * ties * ties - ties;
+			i = j;
+		}
+
+		double const n1{ static_cast<double>(a.size()) };
+		double const n2{ static_cast<double>(b.size()) };
+		double const n{ n1 + n2 };
+
+		double const u{ rankSumA - n1 * (n1 + 1.0) / 2.0 };
+		double const mean{ n1 * n2 / 2.0 };
+		double const variance{ n1 * n2 / 12.0 * ((n + 1.0) - tieTerm / (n * (n - 1.0))) };
+		if (variance <= 0.0)
+		{
+			return 1.0;
+		}
+
+		double const z{ std::max(0.0, std::abs(u - mean) - 0.5) / std::sqrt(variance) };
+		return std::erfc(z / std::sqrt(2.0));
+	}
+}
+
+#endif
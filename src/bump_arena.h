@@ -0,0 +1,107 @@
+#ifndef MAU_BUMP_ARENA_H
+#define MAU_BUMP_ARENA_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+
+namespace Mau
+{
+	// Memory resource that hands out memory by moving a pointer down through chunks taken from an upstream resource.
+	// Deallocating does nothing, memory only goes back upstream on release() or destruction. Bumping down makes the
+	// fast path one subtraction, one mask and one compare; chunks double in size up to MAX_CHUNK_BYTES.
+	class BumpArena final : public std::pmr::memory_resource
+	{
+	public:
+		explicit BumpArena(size_t initialChunkBytes = 64 * 1024, std::pmr::memory_resource* upstream = std::pmr::get_default_resource()) noexcept
+			: m_Upstream{ upstream }
+			, m_NextChunkBytes{ std::max(initialChunkBytes, sizeof(Chunk) + alignof(std::max_align_t)) }
+		{
+		}
+
+		BumpArena(BumpArena const&) = delete;
+		BumpArena& operator=(BumpArena const&) = delete;
+
+		~BumpArena() override
+		{
+			release();
+		}
+
+		// Gives every chunk back upstream, everything handed out so far is gone
+		void release() noexcept
+		{
+			while (m_Chunks)
+			{
+				Chunk* const previous{ m_Chunks->previous };
+				m_Upstream->deallocate(m_Chunks, m_Chunks->bytes, alignof(std::max_align_t));
+				m_Chunks = previous;
+			}
+			m_Begin = 0;
+			m_Current = 0;
+		}
+
+	private:
+		static constexpr size_t MAX_CHUNK_BYTES{ 64 * 1024 * 1024 };
+
+		// Header at the start of every chunk, the rest is handed out from the end down
+		struct Chunk final
+		{
+			Chunk* previous;
+			size_t bytes;
+		};
+
+		std::pmr::memory_resource* m_Upstream;
+		Chunk* m_Chunks{ nullptr };
+		size_t m_NextChunkBytes;
+
+		uintptr_t m_Begin{ 0 };
+		uintptr_t m_Current{ 0 };
+
+		void* do_allocate(size_t bytes, size_t alignment) override
+		{
+			// Zero bytes would hand out the null start of an arena that has no chunk yet
+			bytes = std::max<size_t>(bytes, 1);
+
+			if (bytes <= m_Current - m_Begin)
+			{
+				uintptr_t const ptr{ (m_Current - bytes) & ~(static_cast<uintptr_t>(alignment) - 1) };
+				if (ptr >= m_Begin)
+				{
+					m_Current = ptr;
+					return reinterpret_cast<void*>(ptr);
+				}
+			}
+			return AllocateFromNewChunk(bytes, alignment);
+		}
+
+		void do_deallocate(void*, size_t, size_t) noexcept override
+		{
+		}
+
+		[[nodiscard]] bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override
+		{
+			return this == &other;
+		}
+
+		// The rest of the current chunk is abandoned, a request larger than the next chunk gets a chunk of its own size
+		void* AllocateFromNewChunk(size_t bytes, size_t alignment)
+		{
+			size_t const chunkBytes{ std::max(m_NextChunkBytes, sizeof(Chunk) + bytes + alignment) };
+			auto* const chunk{ static_cast<Chunk*>(m_Upstream->allocate(chunkBytes, alignof(std::max_align_t))) };
+			chunk->previous = m_Chunks;
+			chunk->bytes = chunkBytes;
+			m_Chunks = chunk;
+			m_NextChunkBytes = std::min(m_NextChunkBytes * 2, MAX_CHUNK_BYTES);
+
+			m_Begin = reinterpret_cast<uintptr_t>(chunk) + sizeof(Chunk);
+			m_Current = reinterpret_cast<uintptr_t>(chunk) + chunkBytes;
+
+			uintptr_t const ptr{ (m_Current - bytes) & ~(static_cast<uintptr_t>(alignment) - 1) };
+			m_Current = ptr;
+			return reinterpret_cast<void*>(ptr);
+		}
+	};
+}
+
+#endif
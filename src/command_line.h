@@ -0,0 +1,365 @@
+#ifndef MAU_COMMAND_LINE_H
+#define MAU_COMMAND_LINE_H
+
+#include "benchmark.h"
+#include "benchmark_compare.h"
+
+#include <charconv>
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Mau
+{
+	enum class OutputFormat
+	{
+		Csv,
+		Json,
+		Console
+	};
+
+	struct CommandLineOptions final
+	{
+		BenchmarkConfig config{};
+		BenchmarkFilter filter{};
+
+		// Empty means the default results directory with a file name based on the compiler
+		std::filesystem::path outputPath;
+		OutputFormat format{ OutputFormat::Csv };
+
+		// Results file of an earlier run to compare against, see CompareToBaseline
+		std::optional<std::filesystem::path> baselinePath;
+		CompareConfig compare{};
+
+		bool appendToMaster{ true };
+		bool list{ false };
+		bool help{ false };
+	};
+
+	static void PrintUsage(std::ostream& out, std::string_view program) noexcept
+	{
+		out << "Usage: " << program << " [options]\n"
+			<< "\n"
+			<< "Selection:\n"
+			<< "  --filter <regex>          only run benchmarks whose name matches\n"
+			<< "  --category <regex>        only run benchmarks whose category matches\n"
+			<< "  --list                    print the matching benchmarks and exit\n"
+			<< "\n"
+			<< "Axes:\n"
+			<< "  --sizes <n,n,...>         container sizes for sized benchmarks\n"
+			<< "  --size-range <min:max[:factor]>  geometric size sweep (default 16:100000000:4)\n"
+			<< "  --threads <n,n,...>       thread counts for threaded benchmarks (default 1,2,4,..,hardware threads)\n"
+			<< "\n"
+			<< "Sampling:\n"
+			<< "  --repetitions <n>         fixed number of samples, overrides the registered count\n"
+			<< "  --min-time <ms>           adaptive mode: sample until stable or this budget is spent\n"
+			<< "  --rse <ratio>             adaptive mode: relative standard error of the mean to stop at (default 0.01)\n"
+			<< "  --warmup <n>              untimed iterations before sampling (default 1)\n"
+			<< "  --batch-time <us>         minimum sample time for micro benchmarks (default 100)\n"
+			<< "  --no-perf                 do not open hardware performance counters\n"
+			<< "\n"
+			<< "Isolation:\n"
+			<< "  --isolate                 run every benchmark point in its own process (Linux only)\n"
+			<< "  --pin <cpu>               pin benchmarks to this core (threaded runs use the following cores as well)\n"
+			<< "  --fifo                    run at SCHED_FIFO priority (needs CAP_SYS_NICE)\n"
+			<< "\n"
+			<< "Output:\n"
+			<< "  --out <path>              result file (default: results dir / bench_results_<compiler>.csv)\n"
+			<< "  --format <csv|json|console>\n"
+			<< "  --no-merge                do not append to all_results.csv\n"
+			<< "\n"
+			<< "Comparison:\n"
+			<< "  --compare <csv>           compare against an earlier results file, exits with 2 on a regression\n"
+			<< "  --threshold <ratio>       relative median change that counts (default 0.05)\n"
+			<< "  --alpha <p>               significance level of the Mann-Whitney U test (default 0.01)\n"
+			<< "  --help\n";
+	}
+
+	template <typename T>
+	[[nodiscard]] static bool ParseNumber(std::string_view text, T& value) noexcept
+	{
+		auto const [end, ec] { std::from_chars(text.data(), text.data() + text.size(), value) };
+		return ec == std::errc{} && end == text.data() + text.size();
+	}
+
+	[[nodiscard]] static bool ParseList(std::string_view text, std::vector<size_t>& values) noexcept
+	{
+		values.clear();
+		while (!text.empty())
+		{
+			size_t const comma{ text.find(',') };
+			size_t value{};
+			if (!ParseNumber(text.substr(0, comma), value) || value == 0)
+			{
+				return false;
+			}
+			values.emplace_back(value);
+
+			if (comma == std::string_view::npos)
+			{
+				break;
+			}
+			text.remove_prefix(comma + 1);
+		}
+		return !values.empty();
+	}
+
+	[[nodiscard]] static bool ParseSizeRange(std::string_view text, std::vector<size_t>& sizes) noexcept
+	{
+		std::vector<std::string_view> parts;
+		while (true)
+		{
+			size_t const colon{ text.find(':') };
+			parts.emplace_back(text.substr(0, colon));
+			if (colon == std::string_view::npos)
+			{
+				break;
+			}
+			text.remove_prefix(colon + 1);
+		}
+
+		size_t minSize{};
+		size_t maxSize{};
+		size_t factor{ 4 };
+		if (parts.size() < 2 || parts.size() > 3
+			|| !ParseNumber(parts[0], minSize) || !ParseNumber(parts[1], maxSize)
+			|| (parts.size() == 3 && !ParseNumber(parts[2], factor))
+			|| minSize == 0 || minSize > maxSize || factor < 2)
+		{
+			return false;
+		}
+
+		sizes = GeometricSizes(minSize, maxSize, factor);
+		return true;
+	}
+
+	// Prints the problem to stderr and returns nothing on invalid input
+	[[nodiscard]] static std::optional<CommandLineOptions> ParseCommandLine(int argc, char* argv[], BenchmarkConfig const& defaults) noexcept
+	{
+		CommandLineOptions options{};
+		options.config = defaults;
+
+		std::vector<std::string_view> const args(argv + 1, argv + argc);
+		for (size_t i{ 0 }; i < args.size(); ++i)
+		{
+			std::string_view const arg{ args[i] };
+
+			// Options that take a value
+			auto value
+			{
+				[&]() -> std::optional<std::string_view>
+				{
+					if (i + 1 >= args.size())
+					{
+						std::cerr << "Error: " << arg << " expects a value\n";
+						return std::nullopt;
+					}
+					return args[++i];
+				}
+			};
+
+			auto invalid
+			{
+				[&](std::string_view text)
+				{
+					std::cerr << "Error: invalid value '" << text << "' for " << arg << "\n";
+					return std::nullopt;
+				}
+			};
+
+			if (arg == "--help" || arg == "-h")
+			{
+				options.help = true;
+			}
+			else if (arg == "--list")
+			{
+				options.list = true;
+			}
+			else if (arg == "--no-perf")
+			{
+				options.config.perfCounters = false;
+			}
+			else if (arg == "--isolate")
+			{
+				options.config.isolate = true;
+			}
+			else if (arg == "--fifo")
+			{
+				options.config.realtime = true;
+			}
+			else if (arg == "--pin")
+			{
+				auto const text{ value() };
+				size_t cpu{};
+				if (!text || !ParseNumber(*text, cpu))
+				{
+					return text ? invalid(*text) : std::nullopt;
+				}
+				options.config.pinCpu = cpu;
+			}
+			else if (arg == "--no-merge")
+			{
+				options.appendToMaster = false;
+			}
+			else if (arg == "--filter" || arg == "--category")
+			{
+				auto const text{ value() };
+				if (!text)
+				{
+					return std::nullopt;
+				}
+
+				try
+				{
+					std::regex pattern{ std::string{ *text }, std::regex::ECMAScript | std::regex::optimize };
+					(arg == "--filter" ? options.filter.name : options.filter.category) = std::move(pattern);
+				}
+				catch (std::regex_error const& e)
+				{
+					std::cerr << "Error: invalid regex '" << *text << "' for " << arg << ": " << e.what() << "\n";
+					return std::nullopt;
+				}
+			}
+			else if (arg == "--sizes")
+			{
+				auto const text{ value() };
+				if (!text || !ParseList(*text, options.config.sizes))
+				{
+					return text ? invalid(*text) : std::nullopt;
+				}
+			}
+			else if (arg == "--size-range")
+			{
+				auto const text{ value() };
+				if (!text || !ParseSizeRange(*text, options.config.sizes))
+				{
+					return text ? invalid(*text) : std::nullopt;
+				}
+			}
+			else if (arg == "--threads")
+			{
+				auto const text{ value() };
+				if (!text || !ParseList(*text, options.config.threadCounts))
+				{
+					return text ? invalid(*text) : std::nullopt;
+				}
+			}
+			else if (arg == "--repetitions")
+			{
+				auto const text{ value() };
+				size_t repetitions{};
+				if (!text || !ParseNumber(*text, repetitions) || repetitions == 0)
+				{
+					return text ? invalid(*text) : std::nullopt;
+				}
+				options.config.iterations = repetitions;
+				options.config.adaptive = false;
+			}
+			else if (arg == "--min-time")
+			{
+				auto const text{ value() };
+				if (!text || !ParseNumber(*text, options.config.targetTimeMs) || options.config.targetTimeMs <= 0.0)
+				{
+					return text ? invalid(*text) : std::nullopt;
+				}
+				options.config.adaptive = true;
+			}
+			else if (arg == "--rse")
+			{
+				auto const text{ value() };
+				if (!text || !ParseNumber(*text, options.config.rseThreshold) || options.config.rseThreshold <= 0.0)
+				{
+					return text ? invalid(*text) : std::nullopt;
+				}
+			}
+			else if (arg == "--warmup")
+			{
+				auto const text{ value() };
+				if (!text || !ParseNumber(*text, options.config.warmupIterations))
+				{
+					return text ? invalid(*text) : std::nullopt;
+				}
+			}
+			else if (arg == "--batch-time")
+			{
+				auto const text{ value() };
+				if (!text || !ParseNumber(*text, options.config.minBatchTimeUs) || options.config.minBatchTimeUs <= 0.0)
+				{
+					return text ? invalid(*text) : std::nullopt;
+				}
+			}
+			else if (arg == "--out")
+			{
+				auto const text{ value() };
+				if (!text)
+				{
+					return std::nullopt;
+				}
+				options.outputPath = std::filesystem::path{ *text };
+			}
+			else if (arg == "--compare")
+			{
+				auto const text{ value() };
+				if (!text)
+				{
+					return std::nullopt;
+				}
+				options.baselinePath = std::filesystem::path{ *text };
+			}
+			else if (arg == "--threshold")
+			{
+				auto const text{ value() };
+				if (!text || !ParseNumber(*text, options.compare.threshold) || options.compare.threshold < 0.0)
+				{
+					return text ? invalid(*text) : std::nullopt;
+				}
+			}
+			else if (arg == "--alpha")
+			{
+				auto const text{ value() };
+				if (!text || !ParseNumber(*text, options.compare.alpha) || options.compare.alpha <= 0.0 || options.compare.alpha >= 1.0)
+				{
+					return text ? invalid(*text) : std::nullopt;
+				}
+			}
+			else if (arg == "--format")
+			{
+				auto const text{ value() };
+				if (!text)
+				{
+					return std::nullopt;
+				}
+
+				if (*text == "csv")
+				{
+					options.format = OutputFormat::Csv;
+				}
+				else if (*text == "json")
+				{
+					options.format = OutputFormat::Json;
+				}
+				else if (*text == "console")
+				{
+					options.format = OutputFormat::Console;
+				}
+				else
+				{
+					return invalid(*text);
+				}
+			}
+			else
+			{
+				std::cerr << "Error: unknown option '" << arg << "'\n";
+				return std::nullopt;
+			}
+		}
+
+		return options;
+	}
+}
+
+#endif
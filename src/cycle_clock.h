@@ -0,0 +1,163 @@
+#ifndef MAU_CYCLE_CLOCK_H
+#define MAU_CYCLE_CLOCK_H
+
+#include "singleton.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#	define MAU_HAS_TSC 1
+#	if defined(_MSC_VER)
+#		include <intrin.h>
+#	else
+#		include <cpuid.h>
+#		include <x86intrin.h>
+#	endif
+#else
+#	define MAU_HAS_TSC 0
+#endif
+
+namespace Mau
+{
+	// Low overhead timestamp source. Uses the invariant TSC on x86-64 (calibrated against steady_clock once),
+	// and falls back to steady_clock in nanoseconds when there is no usable TSC.
+	class CycleClock final : public MauCor::Singleton<CycleClock>
+	{
+	public:
+		// Timestamp before the measured region: earlier instructions retire before the TSC is read,
+		// later ones do not start before it is read
+		[[nodiscard]] uint64_t Now() const noexcept
+		{
+		#if MAU_HAS_TSC
+			if (m_UseTsc)
+			{
+				_mm_lfence();
+				uint64_t const tsc{ __rdtsc() };
+				_mm_lfence();
+				return tsc;
+			}
+		#endif
+			return SteadyNs();
+		}
+
+		// Timestamp after the measured region: rdtscp waits for all earlier instructions to finish
+		[[nodiscard]] uint64_t NowEnd() const noexcept
+		{
+		#if MAU_HAS_TSC
+			if (m_UseTsc)
+			{
+				unsigned int aux{};
+				uint64_t const tsc{ __rdtscp(&aux) };
+				_mm_lfence();
+				return tsc;
+			}
+		#endif
+			return SteadyNs();
+		}
+
+		[[nodiscard]] double ToNs(uint64_t ticks) const noexcept
+		{
+			return static_cast<double>(ticks) / m_TicksPerNs;
+		}
+
+		// Cost of an empty Now()/NowEnd() pair, to subtract from measured intervals
+		[[nodiscard]] double OverheadNs() const noexcept
+		{
+			return m_OverheadNs;
+		}
+
+		[[nodiscard]] bool UsesTsc() const noexcept
+		{
+			return m_UseTsc;
+		}
+
+	private:
+		friend class MauCor::Singleton<CycleClock>;
+
+		CycleClock() noexcept
+		{
+			m_UseTsc = HasInvariantTsc();
+			if (m_UseTsc)
+			{
+				Calibrate();
+			}
+
+			uint64_t best{ UINT64_MAX };
+			for (int i{ 0 }; i < 1000; ++i)
+			{
+				uint64_t const start{ Now() };
+				uint64_t const end{ NowEnd() };
+				best = std::min(best, end - start);
+			}
+			m_OverheadNs = ToNs(best);
+		}
+
+		virtual ~CycleClock() override = default;
+
+		[[nodiscard]] static uint64_t SteadyNs() noexcept
+		{
+			using namespace std::chrono;
+			return static_cast<uint64_t>(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+		}
+
+		[[nodiscard]] static bool HasInvariantTsc() noexcept
+		{
+		#if MAU_HAS_TSC
+			// CPUID 0x80000007, EDX bit 8: TSC ticks at a constant rate in all P-/C-states
+		#	if defined(_MSC_VER)
+			int regs[4]{};
+			__cpuid(regs, 0x80000000);
+			if (static_cast<unsigned int>(regs[0]) < 0x80000007u)
+			{
+				return false;
+			}
+			__cpuid(regs, 0x80000007);
+			return (regs[3] & (1 << 8)) != 0;
+		#	else
+			unsigned int eax{}, ebx{}, ecx{}, edx{};
+			if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx))
+			{
+				return false;
+			}
+			return (edx & (1u << 8)) != 0;
+		#	endif
+		#else
+			return false;
+		#endif
+		}
+
+		// Measures the TSC frequency over a short busy wait. If the result is implausible the TSC is not used.
+		void Calibrate() noexcept
+		{
+			using namespace std::chrono;
+
+			auto const steadyStart{ steady_clock::now() };
+			uint64_t const tscStart{ Now() };
+			while (steady_clock::now() - steadyStart < milliseconds{ 20 })
+			{
+			}
+			uint64_t const tscEnd{ NowEnd() };
+			auto const steadyEnd{ steady_clock::now() };
+
+			double const elapsedNs{ duration<double, std::nano>(steadyEnd - steadyStart).count() };
+			double const ticksPerNs{ static_cast<double>(tscEnd - tscStart) / elapsedNs };
+
+			// Anything outside 100 MHz - 10 GHz means the TSC is not usable as a clock
+			if (ticksPerNs < 0.1 || ticksPerNs > 10.0)
+			{
+				m_UseTsc = false;
+				m_TicksPerNs = 1.0;
+				return;
+			}
+			m_TicksPerNs = ticksPerNs;
+		}
+
+		bool m_UseTsc{ false };
+		double m_TicksPerNs{ 1.0 };
+		double m_OverheadNs{ 0.0 };
+	};
+}
+
+#endif
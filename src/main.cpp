@@ -2,25 +2,924 @@
 #include <filesystem>
 
 #include <SG14/flat_map.h>
+#include <SG14/flat_multimap.h>
+#include <SG14/flat_set.h>
+#include <Mau/btree_map.h>
+#include <Mau/buffered_flat_map.h>
+#include <Mau/eytzinger_map.h>
+#include <Mau/parallel_flat_map.h>
+#include <Mau/robin_hood_map.h>
+#include <Mau/slot_map.h>
+#include <Mau/sparse_set.h>
+#include <Mau/swiss_map.h>
 #include <map>
+#include <memory_resource>
+#include <set>
 #include <unordered_map>
 
 #include <string>
+#include <string_view>
 #include <vector>
 
+#include <numeric>
+#include <random>
+
+#include "alloc_tracker.h"
 #include "benchmark.h"
+#include "bump_arena.h"
+#include "command_line.h"
+
+template <typename Map>
+struct MapState final
+{
+	Map map;
+	size_t size;
+
+	// Every key of the map in random order, used by the lookup benchmarks
+	std::vector<int> lookupKeys;
+	size_t nextLookup{ 0 };
+};
+
+// Resources a pmr map can be put on: the process default (new and delete unless replaced), and three that keep the
+// map's nodes close together
+struct DefaultResource final
+{
+};
+
+using MonotonicResource = std::pmr::monotonic_buffer_resource;
+using PoolResource = std::pmr::unsynchronized_pool_resource;
+using BumpResource = Mau::BumpArena;
+
+template <typename Resource>
+[[nodiscard]] std::pmr::memory_resource* ResourceOf(Resource& resource) noexcept
+{
+	if constexpr (std::is_same_v<Resource, DefaultResource>)
+	{
+		return std::pmr::get_default_resource();
+	}
+	else
+	{
+		return &resource;
+	}
+}
+
+// Names a pmr Map allocating from Resource, so the MapState bodies run on it unchanged
+template <typename Map, typename Resource>
+struct OnResource;
+
+template <typename Map, typename Resource>
+struct MapState<OnResource<Map, Resource>> final
+{
+	// Declared before the map, which hands its memory back to the resource when it is destroyed
+	Resource resource;
+	Map map{ ResourceOf(resource) };
+	size_t size;
+
+	std::vector<int> lookupKeys;
+	size_t nextLookup{ 0 };
+};
+
+// Map holding every key below size, a random quarter of which has expired and is erased in one batch
+template <typename Map>
+struct EraseState final
+{
+	Map map;
+	size_t size;
+
+	// Sorted expired keys, and the same set as a flag per key for the predicate based erase
+	std::vector<int> expiredKeys;
+	std::vector<uint8_t> expired;
+};
+
+template <typename Set>
+struct SetState final
+{
+	Set set;
+	size_t size;
+
+	// Every key of the set in random order, used by the lookup benchmarks
+	std::vector<int> lookupKeys;
+};
+
+// Elements visited per range scan, each scan starts at a random key
+constexpr size_t RANGE_SCAN_LENGTH{ 64 };
+
+// Multimaps hold size elements in event buckets of MULTIMAP_BUCKET_SIZE values per key
+constexpr uint32_t MULTIMAP_BUCKET_SIZE{ 4 };
+
+// Map holding every even key below size, and a batch of all keys below size in random order:
+// half of the batch is already present, the other half is new
+template <typename Map>
+struct BulkInsertState final
+{
+	Map map;
+	size_t size;
+
+	std::vector<std::pair<int, float>> batch;
+};
+
+// Map holding the even keys 0, 2, ..., 2 * (size - 1), and a sorted batch of size / Ratio odd keys spread over that range
+template <typename Map>
+struct SortedInsertState final
+{
+	Map map;
+	size_t size;
+
+	std::vector<std::pair<int, float>> batch;
+};
 
-stdext::flat_map<int, float> g_TestFlatMap;
-std::map<int, float> g_TestMap;
-std::unordered_map<int, float> g_TestUnorderedMap;
+// Unsorted input for the range constructors, laid out according to the pattern
+enum class InputPattern
+{
+	Random,
+	Sorted,
+	Reversed,
+	// Only 1024 distinct keys in random order
+	Duplicates
+};
+
+template <typename Map>
+struct ConstructState final
+{
+	Map map;
+	size_t size;
+
+	std::vector<std::pair<int, float>> input;
+};
+
+// Map with size unique string keys. keys owns the strings in insert order, lookupKeys views them in random order,
+// so a lookup only allocates when the map cannot compare against a std::string_view
+template <typename Map>
+struct StringMapState final
+{
+	Map map;
+	size_t size;
+
+	std::vector<std::string> keys;
+	std::vector<std::string_view> lookupKeys;
+};
+
+// Random input for BuildFlatMapParallel, built with threads workers
+template <typename Map>
+struct ParallelConstructState final
+{
+	Map map;
+	size_t size;
+	size_t threads;
+
+	std::vector<std::pair<int, float>> input;
+};
+
+// Hash map filled to a fixed load factor with size random keys, the lookups use those or size keys that are not in
+// it. Every lookup is timed on its own, teardown turns the timings and the map's probe lengths into the reported metrics.
+template <typename Map>
+struct LoadFactorState final
+{
+	Map map;
+	size_t size;
+
+	std::vector<int> lookupKeys;
+	std::vector<uint64_t> latencyTicks;
+
+	Mau::BenchmarkMetrics metrics;
+};
+
+// What identifies an element: the slot map hands out its own handles, the other containers are keyed by an id
+template <typename Container>
+struct HandleType final
+{
+	using type = uint32_t;
+};
 
-uint32_t constexpr TEST_MAP_SIZE{ 1'000'000 };
+template <typename T>
+struct HandleType<Mau::SlotMap<T>> final
+{
+	using type = Mau::SlotMapHandle;
+};
+
+template <typename Container>
+using HandleOf = typename HandleType<Container>::type;
+
+// Container of size float payloads addressed by handle. Ids are handed out like an entity registry does,
+// erased ones are reused first.
+template <typename Container>
+struct HandleState final
+{
+	Container container;
+	size_t size;
 
-void BenchmarkFlatMapIterate()
+	// Handles of the live elements in random order
+	std::vector<HandleOf<Container>> handles;
+	std::vector<uint32_t> freeIds;
+	uint32_t nextId{ 0 };
+
+	// Random positions in handles, the elements the churn benchmark replaces
+	std::vector<uint32_t> picks;
+};
+
+using FlatMap = stdext::flat_map<int, float>;
+using StdMap = std::map<int, float>;
+using UnorderedMap = std::unordered_map<int, float>;
+
+// Not std::less, so flat_map cannot use its branchless search and falls back to the generic std::partition_point
+template <typename T>
+struct OpaqueLess final
+{
+	[[nodiscard]] bool operator()(T const& lhs, T const& rhs) const noexcept
+	{
+		return lhs < rhs;
+	}
+};
+using GenericFlatMap = stdext::flat_map<int, float, OpaqueLess<int>>;
+
+// Ordered like std::map, with the elements in 512 byte leaves that are linked for in-order iteration
+using BTreeMap = Mau::BTreeMap<int, float>;
+
+// Inserts go to a small sorted buffer that is merged into the map in bulk
+using BufferedFlatMap = Mau::BufferedFlatMap<int, float>;
+
+// Open addressing with SIMD probing of control byte groups, elements inline or in their own nodes
+using SwissFlatMap = Mau::SwissFlatMap<int, float>;
+using SwissNodeMap = Mau::SwissNodeMap<int, float>;
+
+// Linear probing that keeps the probe lengths even by displacing elements closer to their home slot
+using RobinHoodMap = Mau::RobinHoodMap<int, float>;
+
+using FlatSet = stdext::flat_set<int>;
+using StdSet = std::set<int>;
+
+using FlatMultiMap = stdext::flat_multimap<int, float>;
+using StdMultiMap = std::multimap<int, float>;
+
+// std::less<> and std::equal_to<> make the string maps look up std::string_view without building a std::string
+struct TransparentStringHash final
+{
+	using is_transparent = void;
+
+	[[nodiscard]] size_t operator()(std::string_view key) const noexcept
+	{
+		return std::hash<std::string_view>{}(key);
+	}
+};
+
+using StringFlatMap = stdext::flat_map<std::string, float, std::less<>>;
+using StringStdMap = std::map<std::string, float, std::less<>>;
+using StringUnorderedMap = std::unordered_map<std::string, float, TransparentStringHash, std::equal_to<>>;
+// std::less<std::string>, every lookup converts the view to a temporary key
+using OpaqueStringFlatMap = stdext::flat_map<std::string, float>;
+
+// Dense float payloads behind generational handles, and behind ids with a paged sparse index
+using PayloadSlotMap = Mau::SlotMap<float>;
+using PayloadSparseSet = Mau::SparseSet<float>;
+
+// Read-only, built from a FlatMap
+using EytzingerFlatMap = Mau::EytzingerMap<int, float>;
+
+// Same containers, but every allocation is reported to Mau::AllocTracker
+using CountedFlatMap = stdext::flat_map<int, float, std::less<int>, std::vector<int, Mau::CountingAllocator<int>>, std::vector<float, Mau::CountingAllocator<float>>>;
+using CountedStdMap = std::map<int, float, std::less<int>, Mau::CountingAllocator<std::pair<int const, float>>>;
+using CountedUnorderedMap = std::unordered_map<int, float, std::hash<int>, std::equal_to<int>, Mau::CountingAllocator<std::pair<int const, float>>>;
+
+// Same containers taking their memory from a std::pmr resource, flat_map through its key and mapped containers
+using PmrFlatMap = stdext::flat_map<int, float, std::less<int>, std::pmr::vector<int>, std::pmr::vector<float>>;
+using PmrStdMap = std::pmr::map<int, float>;
+using PmrUnorderedMap = std::pmr::unordered_map<int, float>;
+
+#pragma region fixtures
+template <typename Map>
+void FillMap(MapState<Map>& state)
+{
+	if (!state.map.empty())
+	{
+		return;
+	}
+
+	// Read-only maps are built from a filled flat_map
+	if constexpr (requires { state.map.emplace(0, 0.0f); })
+	{
+		for (uint32_t i{ 0 }; i < state.size; ++i)
+		{
+			float const value{ Mau::GenerateValue(i) };
+			state.map.emplace(i, value);
+		}
+	}
+	else
+	{
+		FlatMap source;
+		for (uint32_t i{ 0 }; i < state.size; ++i)
+		{
+			float const value{ Mau::GenerateValue(i) };
+			source.emplace(i, value);
+		}
+		state.map = Map{ std::move(source) };
+	}
+}
+
+template <typename Map>
+void FillMapAndLookupKeys(MapState<Map>& state)
+{
+	FillMap(state);
+
+	if (!state.lookupKeys.empty())
+	{
+		return;
+	}
+
+	state.lookupKeys.resize(state.size);
+	std::iota(state.lookupKeys.begin(), state.lookupKeys.end(), 0);
+	std::shuffle(state.lookupKeys.begin(), state.lookupKeys.end(), std::mt19937{ 42 });
+}
+
+// Keys size .. 2 * size - 1 in random order, none of which is in the map
+template <typename Map>
+void FillMapAndMissingKeys(MapState<Map>& state)
+{
+	FillMap(state);
+
+	if (!state.lookupKeys.empty())
+	{
+		return;
+	}
+
+	state.lookupKeys.resize(state.size);
+	std::iota(state.lookupKeys.begin(), state.lookupKeys.end(), static_cast<int>(state.size));
+	std::shuffle(state.lookupKeys.begin(), state.lookupKeys.end(), std::mt19937{ 42 });
+}
+
+// Sizes the table so that size elements fill exactly LoadPercent of its buckets, the maps never grow during the fill
+template <typename Map, size_t LoadPercent, bool Hit>
+void PrepareLoadFactor(LoadFactorState<Map>& state)
+{
+	if (!state.map.empty())
+	{
+		return;
+	}
+
+	// Random keys: dense ones would spread unrealistically evenly over the buckets of both maps
+	std::mt19937 rng{ 42 };
+	std::vector<int> keys;
+	while (keys.size() < state.size * 2)
+	{
+		while (keys.size() < state.size * 2)
+		{
+			keys.emplace_back(static_cast<int>(rng()));
+		}
+		std::sort(keys.begin(), keys.end());
+		keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+	}
+	std::shuffle(keys.begin(), keys.end(), rng);
+
+	state.map.max_load_factor(0.99f);
+	state.map.rehash(static_cast<size_t>(std::ceil(static_cast<double>(state.size) * 100.0 / LoadPercent)));
+	for (size_t i{ 0 }; i < state.size; ++i)
+	{
+		state.map.emplace(keys[i], Mau::GenerateValue(static_cast<uint32_t>(i)));
+	}
+
+	auto const lookupBegin{ keys.begin() + (Hit ? 0 : static_cast<ptrdiff_t>(state.size)) };
+	state.lookupKeys.assign(lookupBegin, lookupBegin + static_cast<ptrdiff_t>(state.size));
+	std::shuffle(state.lookupKeys.begin(), state.lookupKeys.end(), std::mt19937{ 7 });
+	state.latencyTicks.resize(state.size);
+}
+
+// Elements per probe length (index 0: in the home slot), for a chained map the position in the bucket's list
+template <typename Map>
+[[nodiscard]] std::vector<size_t> ProbeHistogram(Map const& map)
+{
+	if constexpr (requires { map.probe_histogram(); })
+	{
+		return map.probe_histogram();
+	}
+	else
+	{
+		std::vector<size_t> histogram;
+		for (size_t b{ 0 }; b < map.bucket_count(); ++b)
+		{
+			size_t const length{ map.bucket_size(b) };
+			if (length > histogram.size())
+			{
+				histogram.resize(length, 0);
+			}
+			for (size_t i{ 0 }; i < length; ++i)
+			{
+				++histogram[i];
+			}
+		}
+		return histogram;
+	}
+}
+
+// Probe length distribution (mean, percentiles and the share of the first few lengths) and the lookup latency percentiles
+// in nanoseconds. A latency includes one timestamp pair, its calibrated overhead is subtracted.
+template <typename Map>
+void ReportLoadFactorMetrics(LoadFactorState<Map>& state)
+{
+	constexpr size_t REPORTED_LENGTHS{ 4 };
+
+	state.metrics.clear();
+	state.metrics.emplace_back("load", static_cast<double>(state.map.load_factor()));
+
+	auto const histogram{ ProbeHistogram(state.map) };
+	double const elements{ static_cast<double>(state.map.size()) };
+
+	double probeSum{ 0.0 };
+	for (size_t length{ 0 }; length < histogram.size(); ++length)
+	{
+		probeSum += static_cast<double>(histogram[length] * length);
+	}
+	state.metrics.emplace_back("probe_mean", probeSum / elements);
+
+	auto probePercentile
+	{
+		[&histogram, elements](double p)
+		{
+			double seen{ 0.0 };
+			for (size_t length{ 0 }; length < histogram.size(); ++length)
+			{
+				seen += static_cast<double>(histogram[length]);
+				if (seen >= p * elements)
+				{
+					return static_cast<double>(length);
+				}
+			}
+			return static_cast<double>(histogram.size());
+		}
+	};
+	state.metrics.emplace_back("probe_p50", probePercentile(0.5));
+	state.metrics.emplace_back("probe_p99", probePercentile(0.99));
+	state.metrics.emplace_back("probe_max", static_cast<double>(histogram.empty() ? 0 : histogram.size() - 1));
+
+	double tail{ elements };
+	for (size_t length{ 0 }; length < REPORTED_LENGTHS; ++length)
+	{
+		double const count{ length < histogram.size() ? static_cast<double>(histogram[length]) : 0.0 };
+		state.metrics.emplace_back("probe_" + std::to_string(length), count / elements);
+		tail -= count;
+	}
+	state.metrics.emplace_back("probe_" + std::to_string(REPORTED_LENGTHS) + "+", tail / elements);
+
+	auto const& clock{ Mau::CycleClock::GetInstance() };
+	double const overheadNs{ clock.OverheadNs() };
+
+	std::vector<double> latencies;
+	latencies.reserve(state.latencyTicks.size());
+	for (uint64_t const ticks : state.latencyTicks)
+	{
+		latencies.emplace_back(std::max(0.0, clock.ToNs(ticks) - overheadNs));
+	}
+	std::sort(latencies.begin(), latencies.end());
+
+	state.metrics.emplace_back("p50_ns", Mau::Percentile(latencies, 0.5));
+	state.metrics.emplace_back("p90_ns", Mau::Percentile(latencies, 0.9));
+	state.metrics.emplace_back("p99_ns", Mau::Percentile(latencies, 0.99));
+	state.metrics.emplace_back("p999_ns", Mau::Percentile(latencies, 0.999));
+	state.metrics.emplace_back("max_ns", latencies.back());
+}
+
+// One scan start per RANGE_SCAN_LENGTH elements, so a call visits about size elements
+template <typename Map>
+void FillMapAndScanStarts(MapState<Map>& state)
+{
+	FillMap(state);
+
+	if (!state.lookupKeys.empty())
+	{
+		return;
+	}
+
+	std::mt19937 rng{ 42 };
+	std::uniform_int_distribution<int> start{ 0, static_cast<int>(state.size) - 1 };
+	state.lookupKeys.resize(std::max<size_t>(1, state.size / RANGE_SCAN_LENGTH));
+	for (int& key : state.lookupKeys)
+	{
+		key = start(rng);
+	}
+}
+
+template <typename Container>
+HandleOf<Container> InsertPayload(HandleState<Container>& state, float value)
+{
+	if constexpr (std::is_same_v<HandleOf<Container>, Mau::SlotMapHandle>)
+	{
+		return state.container.insert(value);
+	}
+	else
+	{
+		uint32_t id{ state.nextId };
+		if (state.freeIds.empty())
+		{
+			++state.nextId;
+		}
+		else
+		{
+			id = state.freeIds.back();
+			state.freeIds.pop_back();
+		}
+
+		state.container.emplace(static_cast<typename Container::key_type>(id), value);
+		return id;
+	}
+}
+
+template <typename Container>
+void ErasePayload(HandleState<Container>& state, HandleOf<Container> handle)
+{
+	if constexpr (std::is_same_v<HandleOf<Container>, Mau::SlotMapHandle>)
+	{
+		state.container.erase(handle);
+	}
+	else
+	{
+		state.container.erase(static_cast<typename Container::key_type>(handle));
+		state.freeIds.emplace_back(handle);
+	}
+}
+
+template <typename Container>
+[[nodiscard]] float LookupPayload(Container const& container, HandleOf<Container> handle)
+{
+	if constexpr (std::is_same_v<HandleOf<Container>, Mau::SlotMapHandle>)
+	{
+		return *container.find(handle);
+	}
+	else
+	{
+		auto const it{ container.find(static_cast<typename Container::key_type>(handle)) };
+		if constexpr (requires { it->second; })
+		{
+			return it->second;
+		}
+		else
+		{
+			return *it;
+		}
+	}
+}
+
+template <typename Container>
+void ResetHandles(HandleState<Container>& state)
+{
+	state.container = Container{};
+	state.handles.clear();
+	state.freeIds.clear();
+	state.nextId = 0;
+}
+
+// size elements with their handles in random order. With Churn, size random elements are erased and replaced
+// afterwards, so slots and ids have been reused and the dense order no longer follows the insert order.
+template <typename Container, bool Churn>
+void PrepareHandles(HandleState<Container>& state)
+{
+	ResetHandles(state);
+
+	std::mt19937 rng{ 42 };
+	for (uint32_t i{ 0 }; i < state.size; ++i)
+	{
+		state.handles.emplace_back(InsertPayload(state, Mau::GenerateValue(i)));
+	}
+
+	if constexpr (Churn)
+	{
+		for (uint32_t i{ 0 }; i < state.size; ++i)
+		{
+			size_t const pick{ rng() % state.size };
+			ErasePayload(state, state.handles[pick]);
+			state.handles[pick] = InsertPayload(state, Mau::GenerateValue(static_cast<uint32_t>(state.size) + i));
+		}
+	}
+
+	std::shuffle(state.handles.begin(), state.handles.end(), rng);
+
+	if (state.picks.empty())
+	{
+		state.picks.resize(state.size);
+		for (uint32_t& pick : state.picks)
+		{
+			pick = static_cast<uint32_t>(rng() % state.size);
+		}
+	}
+}
+
+// Built once, for the read-only benchmarks
+template <typename Container, bool Churn>
+void FillHandles(HandleState<Container>& state)
+{
+	if (state.handles.empty())
+	{
+		PrepareHandles<Container, Churn>(state);
+	}
+}
+
+template <typename Set>
+void FillSet(SetState<Set>& state)
+{
+	if (!state.set.empty())
+	{
+		return;
+	}
+
+	for (uint32_t i{ 0 }; i < state.size; ++i)
+	{
+		state.set.emplace(i);
+	}
+}
+
+template <typename Set>
+void FillSetAndLookupKeys(SetState<Set>& state)
+{
+	FillSet(state);
+
+	if (!state.lookupKeys.empty())
+	{
+		return;
+	}
+
+	state.lookupKeys.resize(state.size);
+	std::iota(state.lookupKeys.begin(), state.lookupKeys.end(), 0);
+	std::shuffle(state.lookupKeys.begin(), state.lookupKeys.end(), std::mt19937{ 42 });
+}
+
+template <typename Set>
+void ResetSet(SetState<Set>& state)
+{
+	state.set = Set{};
+}
+
+template <typename MultiMap>
+void FillMultiMap(MapState<MultiMap>& state)
+{
+	if (!state.map.empty())
+	{
+		return;
+	}
+
+	for (uint32_t i{ 0 }; i < state.size; ++i)
+	{
+		state.map.emplace(i / MULTIMAP_BUCKET_SIZE, Mau::GenerateValue(i));
+	}
+}
+
+// Lookup keys are the bucket keys in random order
+template <typename MultiMap>
+void FillMultiMapAndLookupKeys(MapState<MultiMap>& state)
+{
+	FillMultiMap(state);
+
+	if (!state.lookupKeys.empty())
+	{
+		return;
+	}
+
+	state.lookupKeys.resize((state.size + MULTIMAP_BUCKET_SIZE - 1) / MULTIMAP_BUCKET_SIZE);
+	std::iota(state.lookupKeys.begin(), state.lookupKeys.end(), 0);
+	std::shuffle(state.lookupKeys.begin(), state.lookupKeys.end(), std::mt19937{ 42 });
+}
+
+// Empty map, with every key below size in random order as the insert order
+template <typename Map>
+void PrepareRandomEmplace(MapState<Map>& state)
+{
+	state.map = Map{};
+	if (!state.lookupKeys.empty())
+	{
+		return;
+	}
+
+	state.lookupKeys.resize(state.size);
+	std::iota(state.lookupKeys.begin(), state.lookupKeys.end(), 0);
+	std::shuffle(state.lookupKeys.begin(), state.lookupKeys.end(), std::mt19937{ 42 });
+}
+
+template <typename Map>
+void PrepareErase(EraseState<Map>& state)
+{
+	state.map = Map{};
+	for (uint32_t i{ 0 }; i < state.size; ++i)
+	{
+		state.map.emplace(i, Mau::GenerateValue(i));
+	}
+
+	if (!state.expired.empty())
+	{
+		return;
+	}
+
+	std::mt19937 rng{ 42 };
+	state.expired.resize(state.size);
+	for (uint32_t i{ 0 }; i < state.size; ++i)
+	{
+		state.expired[i] = (rng() % 4 == 0) ? 1 : 0;
+		if (state.expired[i])
+		{
+			state.expiredKeys.emplace_back(i);
+		}
+	}
+}
+
+template <typename Map>
+void PrepareBulkInsert(BulkInsertState<Map>& state)
+{
+	state.map = Map{};
+	for (uint32_t i{ 0 }; i < state.size; i += 2)
+	{
+		state.map.emplace(i, Mau::GenerateValue(i));
+	}
+
+	if (!state.batch.empty())
+	{
+		return;
+	}
+
+	state.batch.reserve(state.size);
+	for (uint32_t i{ 0 }; i < state.size; ++i)
+	{
+		state.batch.emplace_back(i, Mau::GenerateValue(i));
+	}
+	std::shuffle(state.batch.begin(), state.batch.end(), std::mt19937{ 42 });
+}
+
+// Multimap holding every even element of the buckets below size, and a batch of all size elements in random order:
+// every key of the batch already has values in the map, the new ones go behind them
+template <typename MultiMap>
+void PrepareMultiMapBulkInsert(BulkInsertState<MultiMap>& state)
+{
+	state.map = MultiMap{};
+	for (uint32_t i{ 0 }; i < state.size; i += 2)
+	{
+		state.map.emplace(i / MULTIMAP_BUCKET_SIZE, Mau::GenerateValue(i));
+	}
+
+	if (!state.batch.empty())
+	{
+		return;
+	}
+
+	state.batch.reserve(state.size);
+	for (uint32_t i{ 0 }; i < state.size; ++i)
+	{
+		state.batch.emplace_back(i / MULTIMAP_BUCKET_SIZE, Mau::GenerateValue(i));
+	}
+	std::shuffle(state.batch.begin(), state.batch.end(), std::mt19937{ 42 });
+}
+
+template <typename Map, size_t Ratio>
+void PrepareSortedInsert(SortedInsertState<Map>& state)
+{
+	state.map = Map{};
+	for (uint32_t i{ 0 }; i < state.size; ++i)
+	{
+		state.map.emplace(2 * i, Mau::GenerateValue(i));
+	}
+
+	if (!state.batch.empty())
+	{
+		return;
+	}
+
+	state.batch.reserve(state.size / Ratio);
+	for (uint32_t i{ 0 }; i < state.size / Ratio; ++i)
+	{
+		uint32_t const key{ 2 * i * static_cast<uint32_t>(Ratio) + 1 };
+		state.batch.emplace_back(key, Mau::GenerateValue(key));
+	}
+}
+
+template <typename Map, InputPattern Pattern>
+void PrepareConstruct(ConstructState<Map>& state)
+{
+	state.map = Map{};
+	if (!state.input.empty())
+	{
+		return;
+	}
+
+	state.input.reserve(state.size);
+	for (uint32_t i{ 0 }; i < state.size; ++i)
+	{
+		int key{ static_cast<int>(i) };
+		if constexpr (Pattern == InputPattern::Reversed)
+		{
+			key = static_cast<int>(state.size - 1 - i);
+		}
+		else if constexpr (Pattern == InputPattern::Duplicates)
+		{
+			key = static_cast<int>(i % 1024);
+		}
+		state.input.emplace_back(key, Mau::GenerateValue(i));
+	}
+
+	if constexpr (Pattern == InputPattern::Random || Pattern == InputPattern::Duplicates)
+	{
+		std::shuffle(state.input.begin(), state.input.end(), std::mt19937{ 42 });
+	}
+}
+
+template <typename Map>
+void PrepareParallelConstruct(ParallelConstructState<Map>& state)
+{
+	state.map = Map{};
+	if (!state.input.empty())
+	{
+		return;
+	}
+
+	state.input.reserve(state.size);
+	for (uint32_t i{ 0 }; i < state.size; ++i)
+	{
+		state.input.emplace_back(static_cast<int>(i), Mau::GenerateValue(i));
+	}
+	std::shuffle(state.input.begin(), state.input.end(), std::mt19937{ 42 });
+}
+
+// Unique keys with a length mix of identifiers, paths and URLs: 60% of 8 - 15 characters (within the small string buffer),
+// 30% of 16 - 40 and 10% of 41 - 128. The index in base 36 at the end of the key keeps them unique.
+[[nodiscard]] static std::vector<std::string> GenerateStringKeys(size_t count)
+{
+	constexpr std::string_view CHARACTERS{ "abcdefghijklmnopqrstuvwxyz0123456789" };
+
+	std::mt19937 rng{ 42 };
+	std::vector<std::string> keys;
+	keys.reserve(count);
+	for (size_t i{ 0 }; i < count; ++i)
+	{
+		size_t const bucket{ rng() % 10 };
+		size_t const length{ bucket < 6 ? 8 + rng() % 8 : bucket < 9 ? 16 + rng() % 25 : 41 + rng() % 88 };
+
+		std::string id;
+		for (size_t n{ i }; id.empty() || n != 0; n /= CHARACTERS.size())
+		{
+			id += CHARACTERS[n % CHARACTERS.size()];
+		}
+
+		std::string key;
+		key.reserve(length);
+		while (key.size() + id.size() < length)
+		{
+			key += CHARACTERS[rng() % CHARACTERS.size()];
+		}
+		key += id;
+		keys.emplace_back(std::move(key));
+	}
+	return keys;
+}
+
+template <typename Map>
+void PrepareStringKeys(StringMapState<Map>& state)
+{
+	state.map = Map{};
+	if (state.keys.empty())
+	{
+		state.keys = GenerateStringKeys(state.size);
+	}
+}
+
+template <typename Map>
+void FillStringMapAndLookupKeys(StringMapState<Map>& state)
+{
+	if (!state.map.empty())
+	{
+		return;
+	}
+
+	// Built in one go, emplacing random keys one by one is quadratic for the flat maps
+	state.keys = GenerateStringKeys(state.size);
+	std::vector<std::pair<std::string, float>> elements;
+	elements.reserve(state.size);
+	for (uint32_t i{ 0 }; i < state.size; ++i)
+	{
+		elements.emplace_back(state.keys[i], Mau::GenerateValue(i));
+	}
+	state.map = Map(elements.begin(), elements.end());
+
+	state.lookupKeys.assign(state.keys.begin(), state.keys.end());
+	std::shuffle(state.lookupKeys.begin(), state.lookupKeys.end(), std::mt19937{ 42 });
+}
+
+// Replaces the map instead of clearing it, clear() keeps the capacity of flat_map's vectors which would hide its growth cost
+template <typename Map>
+void ResetMap(MapState<Map>& state)
+{
+	state.map = Map{};
+}
+
+// Empties the map and has the resource drop everything it handed out, so every run fills a fresh arena
+template <typename Map, typename Resource>
+void ResetMapOnResource(MapState<OnResource<Map, Resource>>& state)
+{
+	state.map = Map{ ResourceOf(state.resource) };
+	if constexpr (requires { state.resource.release(); })
+	{
+		state.resource.release();
+	}
+}
+#pragma endregion
+
+template <typename Map>
+void BenchmarkIterate(MapState<Map>& state)
 {
 	float sum{ 0.0f };
 
-	for (auto const& item : g_TestFlatMap)
+	for (auto const& item : state.map)
 	{
 		sum += item.second * 2.0f;
 		DO_NOT_OPTIMIZE(sum);
@@ -28,69 +927,358 @@ void BenchmarkFlatMapIterate()
 	CLOBBER_MEMORY();
 }
 
-void BenchmarkMapIterate()
+template <typename Map>
+void BenchmarkEmplace(MapState<Map>& state)
+{
+	for (uint32_t i{ 0 }; i < state.size; ++i)
+	{
+		float const value{ Mau::GenerateValue(i) };
+		state.map.emplace(i, value);
+	}
+}
+
+template <typename Map>
+void BenchmarkRandomEmplace(MapState<Map>& state)
+{
+	for (int const key : state.lookupKeys)
+	{
+		state.map.emplace(key, Mau::GenerateValue(static_cast<uint32_t>(key)));
+	}
+
+	// Ordered access, so a buffered map pays for merging what is still in its buffer
+	DO_NOT_OPTIMIZE(state.map.begin()->second);
+}
+
+// Copies every key into the map, in random order
+template <typename Map>
+void BenchmarkStringEmplace(StringMapState<Map>& state)
+{
+	for (uint32_t i{ 0 }; i < state.size; ++i)
+	{
+		state.map.emplace(state.keys[i], Mau::GenerateValue(i));
+	}
+	DO_NOT_OPTIMIZE(state.map.size());
+}
+
+// Looks up views; a map without transparent lookup gets a std::string built from each one
+template <typename Map>
+void BenchmarkStringLookup(StringMapState<Map>& state)
 {
 	float sum{ 0.0f };
 
-	for (auto& item : g_TestMap)
+	for (std::string_view const key : state.lookupKeys)
 	{
-		sum += item.second * 2.0f;
+		if constexpr (requires { state.map.find(key); })
+		{
+			sum += state.map.find(key)->second;
+		}
+		else
+		{
+			sum += state.map.find(std::string{ key })->second;
+		}
 		DO_NOT_OPTIMIZE(sum);
 	}
 	CLOBBER_MEMORY();
 }
 
+// flat_map's erase_if is found through ADL, std::erase_if is the C++20 overload for the node based maps
+template <typename Map>
+void BenchmarkEraseIf(EraseState<Map>& state)
+{
+	using std::erase_if;
+	auto const erased{ erase_if(state.map, [&state](auto const& item) { return state.expired[item.first] != 0; }) };
+	DO_NOT_OPTIMIZE(erased);
+}
+
+template <typename Map>
+void BenchmarkEraseKeys(EraseState<Map>& state)
+{
+	auto const erased{ state.map.erase(stdext::sorted_unique, state.expiredKeys.begin(), state.expiredKeys.end()) };
+	DO_NOT_OPTIMIZE(erased);
+}
 
-void BenchmarkUnorderedMapIterate()
+template <typename Map>
+void BenchmarkEraseEach(EraseState<Map>& state)
+{
+	for (int const key : state.expiredKeys)
+	{
+		state.map.erase(key);
+	}
+	DO_NOT_OPTIMIZE(state.map.size());
+}
+
+template <typename Set>
+void BenchmarkSetEmplace(SetState<Set>& state)
+{
+	for (uint32_t i{ 0 }; i < state.size; ++i)
+	{
+		state.set.emplace(i);
+	}
+}
+
+template <typename Set>
+void BenchmarkSetIterate(SetState<Set>& state)
+{
+	int sum{ 0 };
+
+	for (int const key : state.set)
+	{
+		sum += key;
+		DO_NOT_OPTIMIZE(sum);
+	}
+	CLOBBER_MEMORY();
+}
+
+template <typename Set>
+void BenchmarkSetLookup(SetState<Set>& state)
+{
+	size_t found{ 0 };
+
+	for (int const key : state.lookupKeys)
+	{
+		found += state.set.count(key);
+		DO_NOT_OPTIMIZE(found);
+	}
+	CLOBBER_MEMORY();
+}
+
+template <typename MultiMap>
+void BenchmarkMultiMapEmplace(MapState<MultiMap>& state)
+{
+	for (uint32_t i{ 0 }; i < state.size; ++i)
+	{
+		state.map.emplace(i / MULTIMAP_BUCKET_SIZE, Mau::GenerateValue(i));
+	}
+}
+
+// Visits every value of the looked up bucket
+template <typename MultiMap>
+void BenchmarkMultiMapLookup(MapState<MultiMap>& state)
 {
 	float sum{ 0.0f };
 
-	for (auto& item : g_TestUnorderedMap)
+	for (int const key : state.lookupKeys)
 	{
-		sum += item.second * 2.0f;
+		auto const [first, last] { state.map.equal_range(key) };
+		for (auto it{ first }; it != last; ++it)
+		{
+			sum += it->second;
+		}
 		DO_NOT_OPTIMIZE(sum);
 	}
 	CLOBBER_MEMORY();
 }
 
-void BenchmarkFlatMapEmplace()
+template <typename Map>
+void BenchmarkBulkInsert(BulkInsertState<Map>& state)
 {
-	g_TestFlatMap.clear();
+	state.map.insert(state.batch.begin(), state.batch.end());
+	DO_NOT_OPTIMIZE(state.map.size());
+}
 
-	for (uint32_t i{ 0 }; i < TEST_MAP_SIZE; ++i)
+template <typename Map>
+void BenchmarkEmplaceEach(BulkInsertState<Map>& state)
+{
+	for (auto const& [key, value] : state.batch)
 	{
-		float const value{ Mau::GenerateValue(i) };
-		g_TestFlatMap.emplace(i, value);
+		state.map.emplace(key, value);
+	}
+	DO_NOT_OPTIMIZE(state.map.size());
+}
+
+template <typename Map>
+void BenchmarkSortedInsert(SortedInsertState<Map>& state)
+{
+	state.map.insert(stdext::sorted_unique, state.batch.begin(), state.batch.end());
+	DO_NOT_OPTIMIZE(state.map.size());
+}
+
+template <typename Map>
+void BenchmarkSortedEmplaceEach(SortedInsertState<Map>& state)
+{
+	for (auto const& [key, value] : state.batch)
+	{
+		state.map.emplace(key, value);
 	}
+	DO_NOT_OPTIMIZE(state.map.size());
+}
+
+template <typename Map>
+void BenchmarkConstruct(ConstructState<Map>& state)
+{
+	state.map = Map(state.input.begin(), state.input.end());
+	DO_NOT_OPTIMIZE(state.map.size());
+}
+
+template <typename Map>
+void BenchmarkParallelConstruct(ParallelConstructState<Map>& state)
+{
+	state.map = Mau::BuildFlatMapParallel<Map>(state.input.begin(), state.input.end(), state.threads);
+	DO_NOT_OPTIMIZE(state.map.size());
+}
+
+// A single find per call, meant for RegisterMicro
+template <typename Map>
+void BenchmarkFind(MapState<Map>& state)
+{
+	int const key{ state.lookupKeys[state.nextLookup] };
+	state.nextLookup = (state.nextLookup + 1 == state.lookupKeys.size()) ? 0 : state.nextLookup + 1;
+
+	auto const it{ state.map.find(key) };
+	DO_NOT_OPTIMIZE(it->second);
 }
 
-void BenchmarkMapEmplace()
-{	
-	g_TestMap.clear();
+template <typename Map>
+void BenchmarkLookup(MapState<Map>& state)
+{
+	float sum{ 0.0f };
 
-	for (uint32_t i{ 0 }; i < TEST_MAP_SIZE; ++i)
+	for (int const key : state.lookupKeys)
 	{
-		float const value{ Mau::GenerateValue(i) };
-		g_TestMap.emplace(i, value);
+		auto const it{ state.map.find(key) };
+		sum += it->second;
+		DO_NOT_OPTIMIZE(sum);
+	}
+	CLOBBER_MEMORY();
+}
+
+template <typename Container>
+void BenchmarkHandleInsert(HandleState<Container>& state)
+{
+	for (uint32_t i{ 0 }; i < state.size; ++i)
+	{
+		InsertPayload(state, Mau::GenerateValue(i));
 	}
+	DO_NOT_OPTIMIZE(state.container.size());
 }
 
+// Erases a random half of the elements by handle
+template <typename Container>
+void BenchmarkHandleErase(HandleState<Container>& state)
+{
+	for (size_t i{ 0 }; i < state.handles.size() / 2; ++i)
+	{
+		ErasePayload(state, state.handles[i]);
+	}
+	DO_NOT_OPTIMIZE(state.container.size());
+}
 
-void BenchmarkUnorderedMapEmplace()
+template <typename Container>
+void BenchmarkHandleLookup(HandleState<Container>& state)
 {
-	g_TestUnorderedMap.clear();
+	float sum{ 0.0f };
 
-	for (uint32_t i{ 0 }; i < TEST_MAP_SIZE; ++i)
+	for (auto const handle : state.handles)
 	{
-		float const value{ Mau::GenerateValue(i) };
-		g_TestUnorderedMap.emplace(i, value);
+		sum += LookupPayload(state.container, handle);
+		DO_NOT_OPTIMIZE(sum);
+	}
+	CLOBBER_MEMORY();
+}
+
+template <typename Container>
+void BenchmarkHandleIterate(HandleState<Container>& state)
+{
+	float sum{ 0.0f };
+
+	for (auto const& item : state.container)
+	{
+		if constexpr (requires { item.second; })
+		{
+			sum += item.second * 2.0f;
+		}
+		else
+		{
+			sum += item * 2.0f;
+		}
+		DO_NOT_OPTIMIZE(sum);
+	}
+	CLOBBER_MEMORY();
+}
+
+// Replaces size random elements, an erase by handle followed by an insert, as entities die and spawn
+template <typename Container>
+void BenchmarkHandleChurn(HandleState<Container>& state)
+{
+	for (uint32_t i{ 0 }; i < state.size; ++i)
+	{
+		uint32_t const pick{ state.picks[i] };
+		ErasePayload(state, state.handles[pick]);
+		state.handles[pick] = InsertPayload(state, Mau::GenerateValue(i));
+	}
+	DO_NOT_OPTIMIZE(state.container.size());
+}
+
+// Seeks to every start key and reads the next RANGE_SCAN_LENGTH elements in order
+template <typename Map>
+void BenchmarkRangeScan(MapState<Map>& state)
+{
+	float sum{ 0.0f };
+
+	for (int const start : state.lookupKeys)
+	{
+		auto it{ state.map.lower_bound(start) };
+		for (size_t i{ 0 }; i < RANGE_SCAN_LENGTH && it != state.map.end(); ++i, ++it)
+		{
+			sum += it->second;
+			DO_NOT_OPTIMIZE(sum);
+		}
+	}
+	CLOBBER_MEMORY();
+}
+
+// Lookups that may miss, so the result is counted instead of dereferenced
+template <typename Map>
+void BenchmarkLookupCount(MapState<Map>& state)
+{
+	size_t found{ 0 };
+
+	for (int const key : state.lookupKeys)
+	{
+		found += state.map.count(key);
+		DO_NOT_OPTIMIZE(found);
 	}
+	CLOBBER_MEMORY();
+}
+
+// Times every lookup on its own, the total includes a timestamp pair per key
+template <typename Map>
+void BenchmarkTimedLookup(LoadFactorState<Map>& state)
+{
+	auto const& clock{ Mau::CycleClock::GetInstance() };
+	size_t found{ 0 };
+
+	for (size_t i{ 0 }; i < state.lookupKeys.size(); ++i)
+	{
+		uint64_t const start{ clock.Now() };
+		found += state.map.count(state.lookupKeys[i]);
+		DO_NOT_OPTIMIZE(found);
+		uint64_t const end{ clock.NowEnd() };
+
+		state.latencyTicks[i] = end - start;
+	}
+	CLOBBER_MEMORY();
 }
 
-int main()
+int main(int argc, char* argv[])
 {
+	Mau::BenchmarkConfig defaults{};
+	defaults.perfCounters = true;
+
+	auto const options{ Mau::ParseCommandLine(argc, argv, defaults) };
+	if (!options)
+	{
+		Mau::PrintUsage(std::cerr, argv[0]);
+		return 1;
+	}
+
+	if (options->help)
+	{
+		Mau::PrintUsage(std::cout, argv[0]);
+		return 0;
+	}
+
 	std::string const compilerInfo{ Mau::GetCompilerInfo() };
-	std::cout << "Running benchmarks for: " << compilerInfo << "\n";
 
 	// Sanitize compiler info for file name
 	std::string safeName{ compilerInfo };
@@ -101,26 +1289,283 @@ int main()
 
 	std::filesystem::path const resultsDir{ std::filesystem::path(PROJECT_RESULTS_DIR) };
 	std::filesystem::create_directories(resultsDir);
-	std::filesystem::path const filePath{ resultsDir / ("bench_results_" + safeName + ".csv") };
+
+	std::string const extension{ options->format == Mau::OutputFormat::Json ? ".json" : ".csv" };
+	std::filesystem::path const filePath{ options->outputPath.empty() ? resultsDir / ("bench_results_" + safeName + extension) : options->outputPath };
 
 #pragma region benchmarking
 	auto& benchmarkReg{ Mau::BenchmarkRegistry::GetInstance() };
-	benchmarkReg.Register("Flat Map Emplace", "Map Emplace", BenchmarkFlatMapEmplace, 10);
-	benchmarkReg.Register("Map Emplace", "Map Emplace", BenchmarkMapEmplace, 10);
-	benchmarkReg.Register("Unordered Map Emplace", "Map Emplace", BenchmarkUnorderedMapEmplace, 10);
+	benchmarkReg.SetConfig(options->config);
+
+	benchmarkReg.Register<MapState<FlatMap>>("Flat Map Emplace", "Map Emplace", nullptr, BenchmarkEmplace<FlatMap>, ResetMap<FlatMap>, 10);
+	benchmarkReg.Register<MapState<BufferedFlatMap>>("Buffered Flat Map Emplace", "Map Emplace", nullptr, BenchmarkEmplace<BufferedFlatMap>, ResetMap<BufferedFlatMap>, 10);
+	benchmarkReg.Register<MapState<StdMap>>("Map Emplace", "Map Emplace", nullptr, BenchmarkEmplace<StdMap>, ResetMap<StdMap>, 10);
+	benchmarkReg.Register<MapState<BTreeMap>>("B+Tree Map Emplace", "Map Emplace", nullptr, BenchmarkEmplace<BTreeMap>, ResetMap<BTreeMap>, 10);
+	benchmarkReg.Register<MapState<UnorderedMap>>("Unordered Map Emplace", "Map Emplace", nullptr, BenchmarkEmplace<UnorderedMap>, ResetMap<UnorderedMap>, 10);
+	benchmarkReg.Register<MapState<SwissFlatMap>>("Swiss Flat Map Emplace", "Map Emplace", nullptr, BenchmarkEmplace<SwissFlatMap>, ResetMap<SwissFlatMap>, 10);
+	benchmarkReg.Register<MapState<SwissNodeMap>>("Swiss Node Map Emplace", "Map Emplace", nullptr, BenchmarkEmplace<SwissNodeMap>, ResetMap<SwissNodeMap>, 10);
+	benchmarkReg.Register<MapState<RobinHoodMap>>("Robin Hood Map Emplace", "Map Emplace", nullptr, BenchmarkEmplace<RobinHoodMap>, ResetMap<RobinHoodMap>, 10);
+
+	// Keys in random order: every flat_map emplace shifts half of the map, the buffered map only its buffer
+	benchmarkReg.Register<MapState<FlatMap>>("Flat Map Random Emplace", "Map Random Emplace", PrepareRandomEmplace<FlatMap>, BenchmarkRandomEmplace<FlatMap>, nullptr, 10, 1 << 18);
+	benchmarkReg.Register<MapState<BufferedFlatMap>>("Buffered Flat Map Random Emplace", "Map Random Emplace", PrepareRandomEmplace<BufferedFlatMap>, BenchmarkRandomEmplace<BufferedFlatMap>, nullptr, 10, 1 << 22);
+	benchmarkReg.Register<MapState<StdMap>>("Map Random Emplace", "Map Random Emplace", PrepareRandomEmplace<StdMap>, BenchmarkRandomEmplace<StdMap>, nullptr, 10);
+	benchmarkReg.Register<MapState<BTreeMap>>("B+Tree Map Random Emplace", "Map Random Emplace", PrepareRandomEmplace<BTreeMap>, BenchmarkRandomEmplace<BTreeMap>, nullptr, 10);
+	benchmarkReg.Register<MapState<UnorderedMap>>("Unordered Map Random Emplace", "Map Random Emplace", PrepareRandomEmplace<UnorderedMap>, BenchmarkRandomEmplace<UnorderedMap>, nullptr, 10);
+	benchmarkReg.Register<MapState<SwissFlatMap>>("Swiss Flat Map Random Emplace", "Map Random Emplace", PrepareRandomEmplace<SwissFlatMap>, BenchmarkRandomEmplace<SwissFlatMap>, nullptr, 10);
+	benchmarkReg.Register<MapState<SwissNodeMap>>("Swiss Node Map Random Emplace", "Map Random Emplace", PrepareRandomEmplace<SwissNodeMap>, BenchmarkRandomEmplace<SwissNodeMap>, nullptr, 10);
+	benchmarkReg.Register<MapState<RobinHoodMap>>("Robin Hood Map Random Emplace", "Map Random Emplace", PrepareRandomEmplace<RobinHoodMap>, BenchmarkRandomEmplace<RobinHoodMap>, nullptr, 10);
+
+	benchmarkReg.Register<MapState<CountedFlatMap>>("Flat Map Emplace (Counted)", "Map Footprint", nullptr, BenchmarkEmplace<CountedFlatMap>, ResetMap<CountedFlatMap>, 10);
+	benchmarkReg.Register<MapState<CountedStdMap>>("Map Emplace (Counted)", "Map Footprint", nullptr, BenchmarkEmplace<CountedStdMap>, ResetMap<CountedStdMap>, 10);
+	benchmarkReg.Register<MapState<CountedUnorderedMap>>("Unordered Map Emplace (Counted)", "Map Footprint", nullptr, BenchmarkEmplace<CountedUnorderedMap>, ResetMap<CountedUnorderedMap>, 10);
+	benchmarkReg.Register<ParallelConstructState<CountedFlatMap>>("Flat Map Parallel Construct (Counted)", "Map Footprint", PrepareParallelConstruct<CountedFlatMap>, BenchmarkParallelConstruct<CountedFlatMap>, nullptr, 10);
+
+	// The emplace, iterate and lookup bodies again, on pmr containers over each memory resource. Keys are emplaced in
+	// order, so an arena lays the nodes of std::map out in iteration order.
+	benchmarkReg.Register<MapState<OnResource<PmrFlatMap, DefaultResource>>>("Flat Map Emplace (Default)", "Allocator Emplace", nullptr, BenchmarkEmplace<OnResource<PmrFlatMap, DefaultResource>>, ResetMapOnResource<PmrFlatMap, DefaultResource>, 10);
+	benchmarkReg.Register<MapState<OnResource<PmrFlatMap, MonotonicResource>>>("Flat Map Emplace (Monotonic)", "Allocator Emplace", nullptr, BenchmarkEmplace<OnResource<PmrFlatMap, MonotonicResource>>, ResetMapOnResource<PmrFlatMap, MonotonicResource>, 10);
+	benchmarkReg.Register<MapState<OnResource<PmrFlatMap, PoolResource>>>("Flat Map Emplace (Pool)", "Allocator Emplace", nullptr, BenchmarkEmplace<OnResource<PmrFlatMap, PoolResource>>, ResetMapOnResource<PmrFlatMap, PoolResource>, 10);
+	benchmarkReg.Register<MapState<OnResource<PmrFlatMap, BumpResource>>>("Flat Map Emplace (Bump Arena)", "Allocator Emplace", nullptr, BenchmarkEmplace<OnResource<PmrFlatMap, BumpResource>>, ResetMapOnResource<PmrFlatMap, BumpResource>, 10);
+	benchmarkReg.Register<MapState<OnResource<PmrStdMap, DefaultResource>>>("Map Emplace (Default)", "Allocator Emplace", nullptr, BenchmarkEmplace<OnResource<PmrStdMap, DefaultResource>>, ResetMapOnResource<PmrStdMap, DefaultResource>, 10);
+	benchmarkReg.Register<MapState<OnResource<PmrStdMap, MonotonicResource>>>("Map Emplace (Monotonic)", "Allocator Emplace", nullptr, BenchmarkEmplace<OnResource<PmrStdMap, MonotonicResource>>, ResetMapOnResource<PmrStdMap, MonotonicResource>, 10);
+	benchmarkReg.Register<MapState<OnResource<PmrStdMap, PoolResource>>>("Map Emplace (Pool)", "Allocator Emplace", nullptr, BenchmarkEmplace<OnResource<PmrStdMap, PoolResource>>, ResetMapOnResource<PmrStdMap, PoolResource>, 10);
+	benchmarkReg.Register<MapState<OnResource<PmrStdMap, BumpResource>>>("Map Emplace (Bump Arena)", "Allocator Emplace", nullptr, BenchmarkEmplace<OnResource<PmrStdMap, BumpResource>>, ResetMapOnResource<PmrStdMap, BumpResource>, 10);
+	benchmarkReg.Register<MapState<OnResource<PmrUnorderedMap, DefaultResource>>>("Unordered Map Emplace (Default)", "Allocator Emplace", nullptr, BenchmarkEmplace<OnResource<PmrUnorderedMap, DefaultResource>>, ResetMapOnResource<PmrUnorderedMap, DefaultResource>, 10);
+	benchmarkReg.Register<MapState<OnResource<PmrUnorderedMap, MonotonicResource>>>("Unordered Map Emplace (Monotonic)", "Allocator Emplace", nullptr, BenchmarkEmplace<OnResource<PmrUnorderedMap, MonotonicResource>>, ResetMapOnResource<PmrUnorderedMap, MonotonicResource>, 10);
+	benchmarkReg.Register<MapState<OnResource<PmrUnorderedMap, PoolResource>>>("Unordered Map Emplace (Pool)", "Allocator Emplace", nullptr, BenchmarkEmplace<OnResource<PmrUnorderedMap, PoolResource>>, ResetMapOnResource<PmrUnorderedMap, PoolResource>, 10);
+	benchmarkReg.Register<MapState<OnResource<PmrUnorderedMap, BumpResource>>>("Unordered Map Emplace (Bump Arena)", "Allocator Emplace", nullptr, BenchmarkEmplace<OnResource<PmrUnorderedMap, BumpResource>>, ResetMapOnResource<PmrUnorderedMap, BumpResource>, 10);
+
+	benchmarkReg.RegisterThreaded<MapState<OnResource<PmrFlatMap, DefaultResource>>>("Flat Map Iterate (Default)", "Allocator Iterate", FillMap<OnResource<PmrFlatMap, DefaultResource>>, BenchmarkIterate<OnResource<PmrFlatMap, DefaultResource>>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<MapState<OnResource<PmrFlatMap, MonotonicResource>>>("Flat Map Iterate (Monotonic)", "Allocator Iterate", FillMap<OnResource<PmrFlatMap, MonotonicResource>>, BenchmarkIterate<OnResource<PmrFlatMap, MonotonicResource>>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<MapState<OnResource<PmrFlatMap, PoolResource>>>("Flat Map Iterate (Pool)", "Allocator Iterate", FillMap<OnResource<PmrFlatMap, PoolResource>>, BenchmarkIterate<OnResource<PmrFlatMap, PoolResource>>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<MapState<OnResource<PmrFlatMap, BumpResource>>>("Flat Map Iterate (Bump Arena)", "Allocator Iterate", FillMap<OnResource<PmrFlatMap, BumpResource>>, BenchmarkIterate<OnResource<PmrFlatMap, BumpResource>>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<MapState<OnResource<PmrStdMap, DefaultResource>>>("Map Iterate (Default)", "Allocator Iterate", FillMap<OnResource<PmrStdMap, DefaultResource>>, BenchmarkIterate<OnResource<PmrStdMap, DefaultResource>>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<MapState<OnResource<PmrStdMap, MonotonicResource>>>("Map Iterate (Monotonic)", "Allocator Iterate", FillMap<OnResource<PmrStdMap, MonotonicResource>>, BenchmarkIterate<OnResource<PmrStdMap, MonotonicResource>>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<MapState<OnResource<PmrStdMap, PoolResource>>>("Map Iterate (Pool)", "Allocator Iterate", FillMap<OnResource<PmrStdMap, PoolResource>>, BenchmarkIterate<OnResource<PmrStdMap, PoolResource>>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<MapState<OnResource<PmrStdMap, BumpResource>>>("Map Iterate (Bump Arena)", "Allocator Iterate", FillMap<OnResource<PmrStdMap, BumpResource>>, BenchmarkIterate<OnResource<PmrStdMap, BumpResource>>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<MapState<OnResource<PmrUnorderedMap, DefaultResource>>>("Unordered Map Iterate (Default)", "Allocator Iterate", FillMap<OnResource<PmrUnorderedMap, DefaultResource>>, BenchmarkIterate<OnResource<PmrUnorderedMap, DefaultResource>>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<MapState<OnResource<PmrUnorderedMap, MonotonicResource>>>("Unordered Map Iterate (Monotonic)", "Allocator Iterate", FillMap<OnResource<PmrUnorderedMap, MonotonicResource>>, BenchmarkIterate<OnResource<PmrUnorderedMap, MonotonicResource>>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<MapState<OnResource<PmrUnorderedMap, PoolResource>>>("Unordered Map Iterate (Pool)", "Allocator Iterate", FillMap<OnResource<PmrUnorderedMap, PoolResource>>, BenchmarkIterate<OnResource<PmrUnorderedMap, PoolResource>>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<MapState<OnResource<PmrUnorderedMap, BumpResource>>>("Unordered Map Iterate (Bump Arena)", "Allocator Iterate", FillMap<OnResource<PmrUnorderedMap, BumpResource>>, BenchmarkIterate<OnResource<PmrUnorderedMap, BumpResource>>, nullptr, 10);
+
+	benchmarkReg.RegisterThreaded<MapState<OnResource<PmrFlatMap, DefaultResource>>>("Flat Map Lookup (Default)", "Allocator Lookup", FillMapAndLookupKeys<OnResource<PmrFlatMap, DefaultResource>>, BenchmarkLookup<OnResource<PmrFlatMap, DefaultResource>>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<MapState<OnResource<PmrFlatMap, MonotonicResource>>>("Flat Map Lookup (Monotonic)", "Allocator Lookup", FillMapAndLookupKeys<OnResource<PmrFlatMap, MonotonicResource>>, BenchmarkLookup<OnResource<PmrFlatMap, MonotonicResource>>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<MapState<OnResource<PmrFlatMap, PoolResource>>>("Flat Map Lookup (Pool)", "Allocator Lookup", FillMapAndLookupKeys<OnResource<PmrFlatMap, PoolResource>>, BenchmarkLookup<OnResource<PmrFlatMap, PoolResource>>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<MapState<OnResource<PmrFlatMap, BumpResource>>>("Flat Map Lookup (Bump Arena)", "Allocator Lookup", FillMapAndLookupKeys<OnResource<PmrFlatMap, BumpResource>>, BenchmarkLookup<OnResource<PmrFlatMap, BumpResource>>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<MapState<OnResource<PmrStdMap, DefaultResource>>>("Map Lookup (Default)", "Allocator Lookup", FillMapAndLookupKeys<OnResource<PmrStdMap, DefaultResource>>, BenchmarkLookup<OnResource<PmrStdMap, DefaultResource>>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<MapState<OnResource<PmrStdMap, MonotonicResource>>>("Map Lookup (Monotonic)", "Allocator Lookup", FillMapAndLookupKeys<OnResource<PmrStdMap, MonotonicResource>>, BenchmarkLookup<OnResource<PmrStdMap, MonotonicResource>>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<MapState<OnResource<PmrStdMap, PoolResource>>>("Map Lookup (Pool)", "Allocator Lookup", FillMapAndLookupKeys<OnResource<PmrStdMap, PoolResource>>, BenchmarkLookup<OnResource<PmrStdMap, PoolResource>>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<MapState<OnResource<PmrStdMap, BumpResource>>>("Map Lookup (Bump Arena)", "Allocator Lookup", FillMapAndLookupKeys<OnResource<PmrStdMap, BumpResource>>, BenchmarkLookup<OnResource<PmrStdMap, BumpResource>>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<MapState<OnResource<PmrUnorderedMap, DefaultResource>>>("Unordered Map Lookup (Default)", "Allocator Lookup", FillMapAndLookupKeys<OnResource<PmrUnorderedMap, DefaultResource>>, BenchmarkLookup<OnResource<PmrUnorderedMap, DefaultResource>>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<MapState<OnResource<PmrUnorderedMap, MonotonicResource>>>("Unordered Map Lookup (Monotonic)", "Allocator Lookup", FillMapAndLookupKeys<OnResource<PmrUnorderedMap, MonotonicResource>>, BenchmarkLookup<OnResource<PmrUnorderedMap, MonotonicResource>>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<MapState<OnResource<PmrUnorderedMap, PoolResource>>>("Unordered Map Lookup (Pool)", "Allocator Lookup", FillMapAndLookupKeys<OnResource<PmrUnorderedMap, PoolResource>>, BenchmarkLookup<OnResource<PmrUnorderedMap, PoolResource>>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<MapState<OnResource<PmrUnorderedMap, BumpResource>>>("Unordered Map Lookup (Bump Arena)", "Allocator Lookup", FillMapAndLookupKeys<OnResource<PmrUnorderedMap, BumpResource>>, BenchmarkLookup<OnResource<PmrUnorderedMap, BumpResource>>, nullptr, 10);
+
+	benchmarkReg.Register<BulkInsertState<FlatMap>>("Flat Map Bulk Insert", "Map Bulk Insert", PrepareBulkInsert<FlatMap>, BenchmarkBulkInsert<FlatMap>, nullptr, 10);
+	// One vector insert per element is quadratic, capped well below the end of the default size sweep
+	benchmarkReg.Register<BulkInsertState<FlatMap>>("Flat Map Emplace Each", "Map Bulk Insert", PrepareBulkInsert<FlatMap>, BenchmarkEmplaceEach<FlatMap>, nullptr, 10, 1 << 18);
+	benchmarkReg.Register<BulkInsertState<StdMap>>("Map Bulk Insert", "Map Bulk Insert", PrepareBulkInsert<StdMap>, BenchmarkBulkInsert<StdMap>, nullptr, 10);
+	benchmarkReg.Register<BulkInsertState<UnorderedMap>>("Unordered Map Bulk Insert", "Map Bulk Insert", PrepareBulkInsert<UnorderedMap>, BenchmarkBulkInsert<UnorderedMap>, nullptr, 10);
+
+	// Batch to map size ratios 1:1, 1:16 and 1:256, the smaller batches are merged by galloping
+	benchmarkReg.Register<SortedInsertState<FlatMap>>("Flat Map Sorted Insert 1:1", "Map Sorted Insert", PrepareSortedInsert<FlatMap, 1>, BenchmarkSortedInsert<FlatMap>, nullptr, 10);
+	benchmarkReg.Register<SortedInsertState<FlatMap>>("Flat Map Sorted Insert 1:16", "Map Sorted Insert", PrepareSortedInsert<FlatMap, 16>, BenchmarkSortedInsert<FlatMap>, nullptr, 10);
+	benchmarkReg.Register<SortedInsertState<FlatMap>>("Flat Map Sorted Insert 1:256", "Map Sorted Insert", PrepareSortedInsert<FlatMap, 256>, BenchmarkSortedInsert<FlatMap>, nullptr, 10);
+	benchmarkReg.Register<SortedInsertState<FlatMap>>("Flat Map Emplace Each 1:1", "Map Sorted Insert", PrepareSortedInsert<FlatMap, 1>, BenchmarkSortedEmplaceEach<FlatMap>, nullptr, 10, 1 << 18);
+	benchmarkReg.Register<SortedInsertState<FlatMap>>("Flat Map Emplace Each 1:16", "Map Sorted Insert", PrepareSortedInsert<FlatMap, 16>, BenchmarkSortedEmplaceEach<FlatMap>, nullptr, 10, 1 << 18);
+	benchmarkReg.Register<SortedInsertState<FlatMap>>("Flat Map Emplace Each 1:256", "Map Sorted Insert", PrepareSortedInsert<FlatMap, 256>, BenchmarkSortedEmplaceEach<FlatMap>, nullptr, 10, 1 << 18);
+
+	// FlatMap sorts int keys with the radix sort, GenericFlatMap with pdqsort
+	benchmarkReg.Register<ConstructState<FlatMap>>("Flat Map Construct Random", "Map Construct", PrepareConstruct<FlatMap, InputPattern::Random>, BenchmarkConstruct<FlatMap>, nullptr, 10);
+	benchmarkReg.Register<ConstructState<FlatMap>>("Flat Map Construct Sorted", "Map Construct", PrepareConstruct<FlatMap, InputPattern::Sorted>, BenchmarkConstruct<FlatMap>, nullptr, 10);
+	benchmarkReg.Register<ConstructState<FlatMap>>("Flat Map Construct Reversed", "Map Construct", PrepareConstruct<FlatMap, InputPattern::Reversed>, BenchmarkConstruct<FlatMap>, nullptr, 10);
+	benchmarkReg.Register<ConstructState<FlatMap>>("Flat Map Construct Duplicates", "Map Construct", PrepareConstruct<FlatMap, InputPattern::Duplicates>, BenchmarkConstruct<FlatMap>, nullptr, 10);
+	benchmarkReg.Register<ConstructState<GenericFlatMap>>("Flat Map Construct Random (pdqsort)", "Map Construct", PrepareConstruct<GenericFlatMap, InputPattern::Random>, BenchmarkConstruct<GenericFlatMap>, nullptr, 10);
+	benchmarkReg.Register<ConstructState<GenericFlatMap>>("Flat Map Construct Sorted (pdqsort)", "Map Construct", PrepareConstruct<GenericFlatMap, InputPattern::Sorted>, BenchmarkConstruct<GenericFlatMap>, nullptr, 10);
+	benchmarkReg.Register<ConstructState<GenericFlatMap>>("Flat Map Construct Reversed (pdqsort)", "Map Construct", PrepareConstruct<GenericFlatMap, InputPattern::Reversed>, BenchmarkConstruct<GenericFlatMap>, nullptr, 10);
+	benchmarkReg.Register<ConstructState<GenericFlatMap>>("Flat Map Construct Duplicates (pdqsort)", "Map Construct", PrepareConstruct<GenericFlatMap, InputPattern::Duplicates>, BenchmarkConstruct<GenericFlatMap>, nullptr, 10);
+	benchmarkReg.Register<ConstructState<StdMap>>("Map Construct Random", "Map Construct", PrepareConstruct<StdMap, InputPattern::Random>, BenchmarkConstruct<StdMap>, nullptr, 10);
+	benchmarkReg.Register<ConstructState<UnorderedMap>>("Unordered Map Construct Random", "Map Construct", PrepareConstruct<UnorderedMap, InputPattern::Random>, BenchmarkConstruct<UnorderedMap>, nullptr, 10);
+
+	// Run for every thread count of the thread axis, each point builds one map with that many workers
+	benchmarkReg.Register<ParallelConstructState<FlatMap>>("Flat Map Parallel Construct", "Map Parallel Construct", PrepareParallelConstruct<FlatMap>, BenchmarkParallelConstruct<FlatMap>, nullptr, 10);
+	benchmarkReg.Register<ParallelConstructState<GenericFlatMap>>("Flat Map Parallel Construct (pdqsort)", "Map Parallel Construct", PrepareParallelConstruct<GenericFlatMap>, BenchmarkParallelConstruct<GenericFlatMap>, nullptr, 10);
+
+	// Prunes a random quarter of the map. Erasing one key at a time shifts the flat_map once per key, capped like Emplace Each.
+	benchmarkReg.Register<EraseState<FlatMap>>("Flat Map Erase If", "Map Erase", PrepareErase<FlatMap>, BenchmarkEraseIf<FlatMap>, nullptr, 10);
+	benchmarkReg.Register<EraseState<FlatMap>>("Flat Map Erase Keys", "Map Erase", PrepareErase<FlatMap>, BenchmarkEraseKeys<FlatMap>, nullptr, 10);
+	benchmarkReg.Register<EraseState<FlatMap>>("Flat Map Erase Each", "Map Erase", PrepareErase<FlatMap>, BenchmarkEraseEach<FlatMap>, nullptr, 10, 1 << 18);
+	benchmarkReg.Register<EraseState<StdMap>>("Map Erase If", "Map Erase", PrepareErase<StdMap>, BenchmarkEraseIf<StdMap>, nullptr, 10);
+	benchmarkReg.Register<EraseState<StdMap>>("Map Erase Each", "Map Erase", PrepareErase<StdMap>, BenchmarkEraseEach<StdMap>, nullptr, 10);
+	benchmarkReg.Register<EraseState<BTreeMap>>("B+Tree Map Erase Each", "Map Erase", PrepareErase<BTreeMap>, BenchmarkEraseEach<BTreeMap>, nullptr, 10);
+	benchmarkReg.Register<EraseState<UnorderedMap>>("Unordered Map Erase If", "Map Erase", PrepareErase<UnorderedMap>, BenchmarkEraseIf<UnorderedMap>, nullptr, 10);
+	benchmarkReg.Register<EraseState<UnorderedMap>>("Unordered Map Erase Each", "Map Erase", PrepareErase<UnorderedMap>, BenchmarkEraseEach<UnorderedMap>, nullptr, 10);
+	// Backward shift deletion moves the following displaced elements one slot back instead of leaving a tombstone
+	benchmarkReg.Register<EraseState<RobinHoodMap>>("Robin Hood Map Erase Each", "Map Erase", PrepareErase<RobinHoodMap>, BenchmarkEraseEach<RobinHoodMap>, nullptr, 10);
+
+	benchmarkReg.RegisterThreaded<MapState<FlatMap>>("Flat Map Iterate", "Map Iterate", FillMap<FlatMap>, BenchmarkIterate<FlatMap>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<MapState<StdMap>>("Map Iterate", "Map Iterate", FillMap<StdMap>, BenchmarkIterate<StdMap>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<MapState<BTreeMap>>("B+Tree Map Iterate", "Map Iterate", FillMap<BTreeMap>, BenchmarkIterate<BTreeMap>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<MapState<UnorderedMap>>("Unordered Map Iterate", "Map Iterate", FillMap<UnorderedMap>, BenchmarkIterate<UnorderedMap>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<MapState<SwissFlatMap>>("Swiss Flat Map Iterate", "Map Iterate", FillMap<SwissFlatMap>, BenchmarkIterate<SwissFlatMap>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<MapState<SwissNodeMap>>("Swiss Node Map Iterate", "Map Iterate", FillMap<SwissNodeMap>, BenchmarkIterate<SwissNodeMap>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<MapState<RobinHoodMap>>("Robin Hood Map Iterate", "Map Iterate", FillMap<RobinHoodMap>, BenchmarkIterate<RobinHoodMap>, nullptr, 10);
+
+	benchmarkReg.RegisterThreaded<MapState<FlatMap>>("Flat Map Lookup", "Map Lookup", FillMapAndLookupKeys<FlatMap>, BenchmarkLookup<FlatMap>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<MapState<GenericFlatMap>>("Flat Map Lookup (Generic Search)", "Map Lookup", FillMapAndLookupKeys<GenericFlatMap>, BenchmarkLookup<GenericFlatMap>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<MapState<BufferedFlatMap>>("Buffered Flat Map Lookup", "Map Lookup", FillMapAndLookupKeys<BufferedFlatMap>, BenchmarkLookup<BufferedFlatMap>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<MapState<EytzingerFlatMap>>("Eytzinger Map Lookup", "Map Lookup", FillMapAndLookupKeys<EytzingerFlatMap>, BenchmarkLookup<EytzingerFlatMap>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<MapState<StdMap>>("Map Lookup", "Map Lookup", FillMapAndLookupKeys<StdMap>, BenchmarkLookup<StdMap>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<MapState<BTreeMap>>("B+Tree Map Lookup", "Map Lookup", FillMapAndLookupKeys<BTreeMap>, BenchmarkLookup<BTreeMap>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<MapState<UnorderedMap>>("Unordered Map Lookup", "Map Lookup", FillMapAndLookupKeys<UnorderedMap>, BenchmarkLookup<UnorderedMap>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<MapState<SwissFlatMap>>("Swiss Flat Map Lookup", "Map Lookup", FillMapAndLookupKeys<SwissFlatMap>, BenchmarkLookup<SwissFlatMap>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<MapState<SwissNodeMap>>("Swiss Node Map Lookup", "Map Lookup", FillMapAndLookupKeys<SwissNodeMap>, BenchmarkLookup<SwissNodeMap>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<MapState<RobinHoodMap>>("Robin Hood Map Lookup", "Map Lookup", FillMapAndLookupKeys<RobinHoodMap>, BenchmarkLookup<RobinHoodMap>, nullptr, 10);
+
+	// A hit compares the key of every slot whose control byte matches, a miss usually stops at the first group with an empty slot
+	benchmarkReg.RegisterThreaded<MapState<UnorderedMap>>("Unordered Map Lookup Hit", "Hash Map Lookup Hit", FillMapAndLookupKeys<UnorderedMap>, BenchmarkLookupCount<UnorderedMap>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<MapState<SwissFlatMap>>("Swiss Flat Map Lookup Hit", "Hash Map Lookup Hit", FillMapAndLookupKeys<SwissFlatMap>, BenchmarkLookupCount<SwissFlatMap>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<MapState<SwissNodeMap>>("Swiss Node Map Lookup Hit", "Hash Map Lookup Hit", FillMapAndLookupKeys<SwissNodeMap>, BenchmarkLookupCount<SwissNodeMap>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<MapState<RobinHoodMap>>("Robin Hood Map Lookup Hit", "Hash Map Lookup Hit", FillMapAndLookupKeys<RobinHoodMap>, BenchmarkLookupCount<RobinHoodMap>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<MapState<UnorderedMap>>("Unordered Map Lookup Miss", "Hash Map Lookup Miss", FillMapAndMissingKeys<UnorderedMap>, BenchmarkLookupCount<UnorderedMap>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<MapState<SwissFlatMap>>("Swiss Flat Map Lookup Miss", "Hash Map Lookup Miss", FillMapAndMissingKeys<SwissFlatMap>, BenchmarkLookupCount<SwissFlatMap>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<MapState<SwissNodeMap>>("Swiss Node Map Lookup Miss", "Hash Map Lookup Miss", FillMapAndMissingKeys<SwissNodeMap>, BenchmarkLookupCount<SwissNodeMap>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<MapState<RobinHoodMap>>("Robin Hood Map Lookup Miss", "Hash Map Lookup Miss", FillMapAndMissingKeys<RobinHoodMap>, BenchmarkLookupCount<RobinHoodMap>, nullptr, 10);
 
-	benchmarkReg.Register("Flat Map Iterate", "Map Iterate", BenchmarkFlatMapIterate, 10);
-	benchmarkReg.Register("Map Iterate", "Map Iterate", BenchmarkMapIterate, 10);
-	benchmarkReg.Register("Unordered Map Iterate", "Map Iterate", BenchmarkUnorderedMapIterate, 10);
+	// The same lookups with the table sized to a fixed load factor. Every result carries the probe length distribution
+	// and the per lookup latency percentiles as metrics; a miss in the Robin Hood map stops at the first shorter probe.
+	benchmarkReg.Register<LoadFactorState<UnorderedMap>>("Unordered Map Lookup Hit (Load 0.50)", "Load Factor Lookup Hit", PrepareLoadFactor<UnorderedMap, 50, true>, BenchmarkTimedLookup<UnorderedMap>, ReportLoadFactorMetrics<UnorderedMap>, 10, 1 << 22);
+	benchmarkReg.Register<LoadFactorState<UnorderedMap>>("Unordered Map Lookup Hit (Load 0.90)", "Load Factor Lookup Hit", PrepareLoadFactor<UnorderedMap, 90, true>, BenchmarkTimedLookup<UnorderedMap>, ReportLoadFactorMetrics<UnorderedMap>, 10, 1 << 22);
+	benchmarkReg.Register<LoadFactorState<UnorderedMap>>("Unordered Map Lookup Hit (Load 0.95)", "Load Factor Lookup Hit", PrepareLoadFactor<UnorderedMap, 95, true>, BenchmarkTimedLookup<UnorderedMap>, ReportLoadFactorMetrics<UnorderedMap>, 10, 1 << 22);
+	benchmarkReg.Register<LoadFactorState<RobinHoodMap>>("Robin Hood Map Lookup Hit (Load 0.50)", "Load Factor Lookup Hit", PrepareLoadFactor<RobinHoodMap, 50, true>, BenchmarkTimedLookup<RobinHoodMap>, ReportLoadFactorMetrics<RobinHoodMap>, 10, 1 << 22);
+	benchmarkReg.Register<LoadFactorState<RobinHoodMap>>("Robin Hood Map Lookup Hit (Load 0.90)", "Load Factor Lookup Hit", PrepareLoadFactor<RobinHoodMap, 90, true>, BenchmarkTimedLookup<RobinHoodMap>, ReportLoadFactorMetrics<RobinHoodMap>, 10, 1 << 22);
+	benchmarkReg.Register<LoadFactorState<RobinHoodMap>>("Robin Hood Map Lookup Hit (Load 0.95)", "Load Factor Lookup Hit", PrepareLoadFactor<RobinHoodMap, 95, true>, BenchmarkTimedLookup<RobinHoodMap>, ReportLoadFactorMetrics<RobinHoodMap>, 10, 1 << 22);
+	benchmarkReg.Register<LoadFactorState<UnorderedMap>>("Unordered Map Lookup Miss (Load 0.50)", "Load Factor Lookup Miss", PrepareLoadFactor<UnorderedMap, 50, false>, BenchmarkTimedLookup<UnorderedMap>, ReportLoadFactorMetrics<UnorderedMap>, 10, 1 << 22);
+	benchmarkReg.Register<LoadFactorState<UnorderedMap>>("Unordered Map Lookup Miss (Load 0.90)", "Load Factor Lookup Miss", PrepareLoadFactor<UnorderedMap, 90, false>, BenchmarkTimedLookup<UnorderedMap>, ReportLoadFactorMetrics<UnorderedMap>, 10, 1 << 22);
+	benchmarkReg.Register<LoadFactorState<UnorderedMap>>("Unordered Map Lookup Miss (Load 0.95)", "Load Factor Lookup Miss", PrepareLoadFactor<UnorderedMap, 95, false>, BenchmarkTimedLookup<UnorderedMap>, ReportLoadFactorMetrics<UnorderedMap>, 10, 1 << 22);
+	benchmarkReg.Register<LoadFactorState<RobinHoodMap>>("Robin Hood Map Lookup Miss (Load 0.50)", "Load Factor Lookup Miss", PrepareLoadFactor<RobinHoodMap, 50, false>, BenchmarkTimedLookup<RobinHoodMap>, ReportLoadFactorMetrics<RobinHoodMap>, 10, 1 << 22);
+	benchmarkReg.Register<LoadFactorState<RobinHoodMap>>("Robin Hood Map Lookup Miss (Load 0.90)", "Load Factor Lookup Miss", PrepareLoadFactor<RobinHoodMap, 90, false>, BenchmarkTimedLookup<RobinHoodMap>, ReportLoadFactorMetrics<RobinHoodMap>, 10, 1 << 22);
+	benchmarkReg.Register<LoadFactorState<RobinHoodMap>>("Robin Hood Map Lookup Miss (Load 0.95)", "Load Factor Lookup Miss", PrepareLoadFactor<RobinHoodMap, 95, false>, BenchmarkTimedLookup<RobinHoodMap>, ReportLoadFactorMetrics<RobinHoodMap>, 10, 1 << 22);
 
-	auto const results{ benchmarkReg.RunAll() };
+	benchmarkReg.RegisterMicro<MapState<FlatMap>>("Flat Map Find", "Map Find", FillMapAndLookupKeys<FlatMap>, BenchmarkFind<FlatMap>, nullptr, 10);
+	benchmarkReg.RegisterMicro<MapState<GenericFlatMap>>("Flat Map Find (Generic Search)", "Map Find", FillMapAndLookupKeys<GenericFlatMap>, BenchmarkFind<GenericFlatMap>, nullptr, 10);
+	benchmarkReg.RegisterMicro<MapState<EytzingerFlatMap>>("Eytzinger Map Find", "Map Find", FillMapAndLookupKeys<EytzingerFlatMap>, BenchmarkFind<EytzingerFlatMap>, nullptr, 10);
+	benchmarkReg.RegisterMicro<MapState<StdMap>>("Map Find", "Map Find", FillMapAndLookupKeys<StdMap>, BenchmarkFind<StdMap>, nullptr, 10);
+	benchmarkReg.RegisterMicro<MapState<BTreeMap>>("B+Tree Map Find", "Map Find", FillMapAndLookupKeys<BTreeMap>, BenchmarkFind<BTreeMap>, nullptr, 10);
+	benchmarkReg.RegisterMicro<MapState<UnorderedMap>>("Unordered Map Find", "Map Find", FillMapAndLookupKeys<UnorderedMap>, BenchmarkFind<UnorderedMap>, nullptr, 10);
+
+	// A seek followed by an in-order walk: the B+ tree follows its leaf links, std::map its node pointers
+	benchmarkReg.RegisterThreaded<MapState<FlatMap>>("Flat Map Range Scan", "Map Range Scan", FillMapAndScanStarts<FlatMap>, BenchmarkRangeScan<FlatMap>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<MapState<StdMap>>("Map Range Scan", "Map Range Scan", FillMapAndScanStarts<StdMap>, BenchmarkRangeScan<StdMap>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<MapState<BTreeMap>>("B+Tree Map Range Scan", "Map Range Scan", FillMapAndScanStarts<BTreeMap>, BenchmarkRangeScan<BTreeMap>, nullptr, 10);
+
+	// Keys are about 30 characters on average, the sweep stops at 1 << 22 to bound the memory use. Random order emplaces
+	// shift half of the flat_map's 32 byte strings each, capped lower than the int keys of Map Random Emplace.
+	benchmarkReg.Register<StringMapState<StringFlatMap>>("Flat Map String Emplace", "String Map Emplace", PrepareStringKeys<StringFlatMap>, BenchmarkStringEmplace<StringFlatMap>, nullptr, 10, 1 << 14);
+	benchmarkReg.Register<StringMapState<StringStdMap>>("Map String Emplace", "String Map Emplace", PrepareStringKeys<StringStdMap>, BenchmarkStringEmplace<StringStdMap>, nullptr, 10, 1 << 22);
+	benchmarkReg.Register<StringMapState<StringUnorderedMap>>("Unordered Map String Emplace", "String Map Emplace", PrepareStringKeys<StringUnorderedMap>, BenchmarkStringEmplace<StringUnorderedMap>, nullptr, 10, 1 << 22);
+
+	// With TRACK_ALLOCATIONS the Allocations column shows that only the map without transparent lookup allocates
+	benchmarkReg.RegisterThreaded<StringMapState<StringFlatMap>>("Flat Map String Lookup", "String Map Lookup", FillStringMapAndLookupKeys<StringFlatMap>, BenchmarkStringLookup<StringFlatMap>, nullptr, 10, 1 << 22);
+	benchmarkReg.RegisterThreaded<StringMapState<OpaqueStringFlatMap>>("Flat Map String Lookup (Key Temporaries)", "String Map Lookup", FillStringMapAndLookupKeys<OpaqueStringFlatMap>, BenchmarkStringLookup<OpaqueStringFlatMap>, nullptr, 10, 1 << 22);
+	benchmarkReg.RegisterThreaded<StringMapState<StringStdMap>>("Map String Lookup", "String Map Lookup", FillStringMapAndLookupKeys<StringStdMap>, BenchmarkStringLookup<StringStdMap>, nullptr, 10, 1 << 22);
+	benchmarkReg.RegisterThreaded<StringMapState<StringUnorderedMap>>("Unordered Map String Lookup", "String Map Lookup", FillStringMapAndLookupKeys<StringUnorderedMap>, BenchmarkStringLookup<StringUnorderedMap>, nullptr, 10, 1 << 22);
+
+	// Ids are handed out in increasing order, so the flat_map inserts append. Churn reuses ids at random positions,
+	// which makes every flat_map insert and erase shift half of it: those are capped like the other per-element edits.
+	benchmarkReg.Register<HandleState<PayloadSlotMap>>("Slot Map Insert", "Handle Insert", nullptr, BenchmarkHandleInsert<PayloadSlotMap>, ResetHandles<PayloadSlotMap>, 10);
+	benchmarkReg.Register<HandleState<PayloadSparseSet>>("Sparse Set Insert", "Handle Insert", nullptr, BenchmarkHandleInsert<PayloadSparseSet>, ResetHandles<PayloadSparseSet>, 10);
+	benchmarkReg.Register<HandleState<FlatMap>>("Flat Map Handle Insert", "Handle Insert", nullptr, BenchmarkHandleInsert<FlatMap>, ResetHandles<FlatMap>, 10);
+	benchmarkReg.Register<HandleState<UnorderedMap>>("Unordered Map Handle Insert", "Handle Insert", nullptr, BenchmarkHandleInsert<UnorderedMap>, ResetHandles<UnorderedMap>, 10);
+
+	benchmarkReg.Register<HandleState<PayloadSlotMap>>("Slot Map Erase", "Handle Erase", PrepareHandles<PayloadSlotMap, false>, BenchmarkHandleErase<PayloadSlotMap>, nullptr, 10);
+	benchmarkReg.Register<HandleState<PayloadSparseSet>>("Sparse Set Erase", "Handle Erase", PrepareHandles<PayloadSparseSet, false>, BenchmarkHandleErase<PayloadSparseSet>, nullptr, 10);
+	benchmarkReg.Register<HandleState<FlatMap>>("Flat Map Handle Erase", "Handle Erase", PrepareHandles<FlatMap, false>, BenchmarkHandleErase<FlatMap>, nullptr, 10, 1 << 18);
+	benchmarkReg.Register<HandleState<UnorderedMap>>("Unordered Map Handle Erase", "Handle Erase", PrepareHandles<UnorderedMap, false>, BenchmarkHandleErase<UnorderedMap>, nullptr, 10);
+
+	benchmarkReg.RegisterThreaded<HandleState<PayloadSlotMap>>("Slot Map Lookup", "Handle Lookup", FillHandles<PayloadSlotMap, true>, BenchmarkHandleLookup<PayloadSlotMap>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<HandleState<PayloadSparseSet>>("Sparse Set Lookup", "Handle Lookup", FillHandles<PayloadSparseSet, true>, BenchmarkHandleLookup<PayloadSparseSet>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<HandleState<FlatMap>>("Flat Map Handle Lookup", "Handle Lookup", FillHandles<FlatMap, true>, BenchmarkHandleLookup<FlatMap>, nullptr, 10, 1 << 18);
+	benchmarkReg.RegisterThreaded<HandleState<UnorderedMap>>("Unordered Map Handle Lookup", "Handle Lookup", FillHandles<UnorderedMap, true>, BenchmarkHandleLookup<UnorderedMap>, nullptr, 10);
+
+	benchmarkReg.RegisterThreaded<HandleState<PayloadSlotMap>>("Slot Map Iterate", "Handle Iterate", FillHandles<PayloadSlotMap, true>, BenchmarkHandleIterate<PayloadSlotMap>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<HandleState<PayloadSparseSet>>("Sparse Set Iterate", "Handle Iterate", FillHandles<PayloadSparseSet, true>, BenchmarkHandleIterate<PayloadSparseSet>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<HandleState<FlatMap>>("Flat Map Handle Iterate", "Handle Iterate", FillHandles<FlatMap, true>, BenchmarkHandleIterate<FlatMap>, nullptr, 10, 1 << 18);
+	benchmarkReg.RegisterThreaded<HandleState<UnorderedMap>>("Unordered Map Handle Iterate", "Handle Iterate", FillHandles<UnorderedMap, true>, BenchmarkHandleIterate<UnorderedMap>, nullptr, 10);
+
+	benchmarkReg.Register<HandleState<PayloadSlotMap>>("Slot Map Churn", "Handle Churn", PrepareHandles<PayloadSlotMap, true>, BenchmarkHandleChurn<PayloadSlotMap>, nullptr, 10);
+	benchmarkReg.Register<HandleState<PayloadSparseSet>>("Sparse Set Churn", "Handle Churn", PrepareHandles<PayloadSparseSet, true>, BenchmarkHandleChurn<PayloadSparseSet>, nullptr, 10);
+	benchmarkReg.Register<HandleState<FlatMap>>("Flat Map Handle Churn", "Handle Churn", PrepareHandles<FlatMap, true>, BenchmarkHandleChurn<FlatMap>, nullptr, 10, 1 << 18);
+	benchmarkReg.Register<HandleState<UnorderedMap>>("Unordered Map Handle Churn", "Handle Churn", PrepareHandles<UnorderedMap, true>, BenchmarkHandleChurn<UnorderedMap>, nullptr, 10);
+
+	benchmarkReg.Register<SetState<FlatSet>>("Flat Set Emplace", "Set Emplace", nullptr, BenchmarkSetEmplace<FlatSet>, ResetSet<FlatSet>, 10);
+	benchmarkReg.Register<SetState<StdSet>>("Set Emplace", "Set Emplace", nullptr, BenchmarkSetEmplace<StdSet>, ResetSet<StdSet>, 10);
+
+	benchmarkReg.RegisterThreaded<SetState<FlatSet>>("Flat Set Iterate", "Set Iterate", FillSet<FlatSet>, BenchmarkSetIterate<FlatSet>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<SetState<StdSet>>("Set Iterate", "Set Iterate", FillSet<StdSet>, BenchmarkSetIterate<StdSet>, nullptr, 10);
+
+	benchmarkReg.RegisterThreaded<SetState<FlatSet>>("Flat Set Lookup", "Set Lookup", FillSetAndLookupKeys<FlatSet>, BenchmarkSetLookup<FlatSet>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<SetState<StdSet>>("Set Lookup", "Set Lookup", FillSetAndLookupKeys<StdSet>, BenchmarkSetLookup<StdSet>, nullptr, 10);
+
+	benchmarkReg.Register<MapState<FlatMultiMap>>("Flat Multimap Emplace", "Multimap Emplace", nullptr, BenchmarkMultiMapEmplace<FlatMultiMap>, ResetMap<FlatMultiMap>, 10);
+	benchmarkReg.Register<MapState<StdMultiMap>>("Multimap Emplace", "Multimap Emplace", nullptr, BenchmarkMultiMapEmplace<StdMultiMap>, ResetMap<StdMultiMap>, 10);
+
+	benchmarkReg.RegisterThreaded<MapState<FlatMultiMap>>("Flat Multimap Iterate", "Multimap Iterate", FillMultiMap<FlatMultiMap>, BenchmarkIterate<FlatMultiMap>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<MapState<StdMultiMap>>("Multimap Iterate", "Multimap Iterate", FillMultiMap<StdMultiMap>, BenchmarkIterate<StdMultiMap>, nullptr, 10);
+
+	benchmarkReg.RegisterThreaded<MapState<FlatMultiMap>>("Flat Multimap Lookup", "Multimap Lookup", FillMultiMapAndLookupKeys<FlatMultiMap>, BenchmarkMultiMapLookup<FlatMultiMap>, nullptr, 10);
+	benchmarkReg.RegisterThreaded<MapState<StdMultiMap>>("Multimap Lookup", "Multimap Lookup", FillMultiMapAndLookupKeys<StdMultiMap>, BenchmarkMultiMapLookup<StdMultiMap>, nullptr, 10);
+
+	benchmarkReg.Register<BulkInsertState<FlatMultiMap>>("Flat Multimap Bulk Insert", "Multimap Bulk Insert", PrepareMultiMapBulkInsert<FlatMultiMap>, BenchmarkBulkInsert<FlatMultiMap>, nullptr, 10);
+	benchmarkReg.Register<BulkInsertState<StdMultiMap>>("Multimap Bulk Insert", "Multimap Bulk Insert", PrepareMultiMapBulkInsert<StdMultiMap>, BenchmarkBulkInsert<StdMultiMap>, nullptr, 10);
+
+	if (options->list)
+	{
+		benchmarkReg.List(std::cout, options->filter);
+		return 0;
+	}
+
+	// Loaded before running, the baseline may be the file this run overwrites
+	std::optional<std::vector<Mau::BaselineResult>> baseline;
+	if (options->baselinePath)
+	{
+		baseline = Mau::LoadBaseline(*options->baselinePath);
+		if (!baseline)
+		{
+			return 1;
+		}
+	}
+
+	std::cout << "Running benchmarks for: " << compilerInfo << "\n";
+
+	auto const results{ benchmarkReg.RunAll(options->filter) };
 #pragma endregion
 
-	benchmarkReg.WriteCsv(filePath, compilerInfo, results);
+	switch (options->format)
+	{
+	case Mau::OutputFormat::Csv:
+		benchmarkReg.WriteCsv(filePath, compilerInfo, results);
+		break;
+	case Mau::OutputFormat::Json:
+		benchmarkReg.WriteJson(filePath, compilerInfo, results);
+		break;
+	case Mau::OutputFormat::Console:
+		benchmarkReg.PrintResults(std::cout, results);
+		break;
+	}
 
-	std::filesystem::path const mergedFile{ resultsDir / "all_results.csv" };
+	if (options->appendToMaster)
+	{
+		std::filesystem::path const mergedFile{ resultsDir / "all_results.csv" };
 
-	benchmarkReg.AppendToMasterResults(mergedFile, compilerInfo, results);
+		benchmarkReg.AppendToMasterResults(mergedFile, compilerInfo, results);
+	}
+
+	if (baseline && Mau::CompareToBaseline(std::cout, results, *baseline, options->compare))
+	{
+		return 2;
+	}
 
 	return 0;
 }
\ No newline at end of file
@@ -0,0 +1,202 @@
+#ifndef MAU_PERF_COUNTERS_H
+#define MAU_PERF_COUNTERS_H
+
+#include <array>
+#include <cstdint>
+
+#if defined(__linux__)
+#	include <linux/perf_event.h>
+#	include <sys/ioctl.h>
+#	include <sys/syscall.h>
+#	include <unistd.h>
+#endif
+
+namespace Mau
+{
+	// Hardware counter values; a negative value means the event could not be counted on this machine
+	struct PerfCounterValues final
+	{
+		double cycles{ -1.0 };
+		double instructions{ -1.0 };
+		double l1dMisses{ -1.0 };
+		double llcMisses{ -1.0 };
+		double dtlbMisses{ -1.0 };
+		double branchMisses{ -1.0 };
+	};
+
+#if defined(__linux__)
+	[[nodiscard]] static constexpr uint64_t PerfCacheConfig(uint64_t cache, uint64_t op, uint64_t result) noexcept
+	{
+		return cache | (op << 8) | (result << 16);
+	}
+#endif
+
+	// Group of perf events that is enabled and disabled atomically around the timed region.
+	// Only available on Linux, when the kernel allows user space counting (perf_event_paranoid <= 2, no seccomp filter in containers).
+	class PerfCounterGroup final
+	{
+	public:
+		PerfCounterGroup() noexcept
+		{
+		#if defined(__linux__)
+			for (size_t i{ 0 }; i < EVENT_COUNT; ++i)
+			{
+				perf_event_attr attr{};
+				attr.size = sizeof(perf_event_attr);
+				attr.type = EVENTS[i].type;
+				attr.config = EVENTS[i].config;
+				attr.disabled = (m_LeaderFd == -1) ? 1 : 0;
+				attr.exclude_kernel = 1;
+				attr.exclude_hv = 1;
+				attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+				int const fd{ static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, m_LeaderFd, 0)) };
+				if (fd == -1)
+				{
+					// Without a leader (cycles) there is no group to attach the other events to
+					if (m_LeaderFd == -1)
+					{
+						return;
+					}
+					continue;
+				}
+
+				if (m_LeaderFd == -1)
+				{
+					m_LeaderFd = fd;
+				}
+
+				m_Fds[i] = fd;
+				ioctl(fd, PERF_EVENT_IOC_ID, &m_Ids[i]);
+			}
+		#endif
+		}
+
+		~PerfCounterGroup()
+		{
+		#if defined(__linux__)
+			for (int const fd : m_Fds)
+			{
+				if (fd != -1)
+				{
+					close(fd);
+				}
+			}
+		#endif
+		}
+
+		PerfCounterGroup(PerfCounterGroup const&) = delete;
+		PerfCounterGroup(PerfCounterGroup&&) = delete;
+		PerfCounterGroup& operator=(PerfCounterGroup const&) = delete;
+		PerfCounterGroup& operator=(PerfCounterGroup&&) = delete;
+
+		[[nodiscard]] bool IsAvailable() const noexcept
+		{
+			return m_LeaderFd != -1;
+		}
+
+		void Start() noexcept
+		{
+		#if defined(__linux__)
+			if (IsAvailable())
+			{
+				ioctl(m_LeaderFd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+				ioctl(m_LeaderFd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+			}
+		#endif
+		}
+
+		void Stop() noexcept
+		{
+		#if defined(__linux__)
+			if (IsAvailable())
+			{
+				ioctl(m_LeaderFd, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+			}
+		#endif
+		}
+
+		// Reads the counters of the last Start/Stop window, scaled up when the kernel had to multiplex the group.
+		// Returns false when the group was never scheduled on the PMU.
+		[[nodiscard]] bool Read(PerfCounterValues& values) const noexcept
+		{
+		#if defined(__linux__)
+			if (!IsAvailable())
+			{
+				return false;
+			}
+
+			struct ReadFormat final
+			{
+				uint64_t nr;
+				uint64_t timeEnabled;
+				uint64_t timeRunning;
+				struct
+				{
+					uint64_t value;
+					uint64_t id;
+				} values[EVENT_COUNT];
+			} data{};
+
+			if (read(m_LeaderFd, &data, sizeof(data)) <= 0 || data.timeRunning == 0)
+			{
+				return false;
+			}
+
+			double const scale{ static_cast<double>(data.timeEnabled) / static_cast<double>(data.timeRunning) };
+
+			std::array<double, EVENT_COUNT> counts{};
+			counts.fill(-1.0);
+			for (size_t v{ 0 }; v < data.nr && v < EVENT_COUNT; ++v)
+			{
+				for (size_t i{ 0 }; i < EVENT_COUNT; ++i)
+				{
+					if (m_Fds[i] != -1 && m_Ids[i] == data.values[v].id)
+					{
+						counts[i] = static_cast<double>(data.values[v].value) * scale;
+					}
+				}
+			}
+
+			values.cycles = counts[0];
+			values.instructions = counts[1];
+			values.l1dMisses = counts[2];
+			values.llcMisses = counts[3];
+			values.dtlbMisses = counts[4];
+			values.branchMisses = counts[5];
+			return true;
+		#else
+			(void)values;
+			return false;
+		#endif
+		}
+
+	private:
+		static constexpr size_t EVENT_COUNT{ 6 };
+
+	#if defined(__linux__)
+		struct EventDesc final
+		{
+			uint32_t type;
+			uint64_t config;
+		};
+
+		// Order matches the fields of PerfCounterValues; cycles is the group leader
+		static constexpr std::array<EventDesc, EVENT_COUNT> EVENTS
+		{ {
+			{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+			{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+			{ PERF_TYPE_HW_CACHE, PerfCacheConfig(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS) },
+			{ PERF_TYPE_HW_CACHE, PerfCacheConfig(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS) },
+			{ PERF_TYPE_HW_CACHE, PerfCacheConfig(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS) },
+			{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+		} };
+	#endif
+
+		int m_LeaderFd{ -1 };
+		std::array<int, EVENT_COUNT> m_Fds{ -1, -1, -1, -1, -1, -1 };
+		std::array<uint64_t, EVENT_COUNT> m_Ids{};
+	};
+}
+
+#endif
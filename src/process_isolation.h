@@ -0,0 +1,200 @@
+#ifndef MAU_PROCESS_ISOLATION_H
+#define MAU_PROCESS_ISOLATION_H
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#	include <sched.h>
+#	include <sys/wait.h>
+#	include <unistd.h>
+#endif
+
+namespace Mau
+{
+	[[nodiscard]] static constexpr bool IsProcessIsolationSupported() noexcept
+	{
+	#if defined(__linux__)
+		return true;
+	#else
+		return false;
+	#endif
+	}
+
+	// Restricts the calling process (and every thread it creates afterwards) to count cores, starting at firstCpu.
+	// Only cores in the affinity mask the process started with are used (cgroups and taskset can leave gaps in the
+	// ids), an unavailable firstCpu starts at the next available core and the cores wrap around when count exceeds them.
+	static bool PinToCpus(size_t firstCpu, size_t count) noexcept
+	{
+	#if defined(__linux__)
+		cpu_set_t allowed;
+		CPU_ZERO(&allowed);
+		if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+		{
+			std::cerr << "Warning: could not read the cpu affinity: " << std::strerror(errno) << "\n";
+			return false;
+		}
+
+		std::vector<size_t> cpus;
+		for (size_t cpu{ 0 }; cpu < CPU_SETSIZE; ++cpu)
+		{
+			if (CPU_ISSET(cpu, &allowed))
+			{
+				cpus.emplace_back(cpu);
+			}
+		}
+		if (cpus.empty())
+		{
+			return false;
+		}
+
+		size_t const start{ static_cast<size_t>(std::lower_bound(cpus.begin(), cpus.end(), firstCpu) - cpus.begin()) % cpus.size() };
+		if (cpus[start] != firstCpu)
+		{
+			std::cerr << "Warning: cpu " << firstCpu << " is not available to this process, pinning to cpu " << cpus[start] << " instead\n";
+		}
+
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		for (size_t i{ 0 }; i < std::max<size_t>(1, count); ++i)
+		{
+			CPU_SET(cpus[(start + i) % cpus.size()], &set);
+		}
+
+		if (sched_setaffinity(0, sizeof(set), &set) != 0)
+		{
+			std::cerr << "Warning: could not pin to cpu " << cpus[start] << ": " << std::strerror(errno) << "\n";
+			return false;
+		}
+		return true;
+	#else
+		(void)firstCpu;
+		(void)count;
+		return false;
+	#endif
+	}
+
+	// Lowest SCHED_FIFO priority is enough to never be preempted by normal tasks. Needs CAP_SYS_NICE (or root).
+	static bool SetRealtimePriority() noexcept
+	{
+	#if defined(__linux__)
+		sched_param param{};
+		param.sched_priority = sched_get_priority_min(SCHED_FIFO);
+		if (sched_setscheduler(0, SCHED_FIFO, &param) != 0)
+		{
+			std::cerr << "Warning: could not switch to SCHED_FIFO: " << std::strerror(errno) << "\n";
+			return false;
+		}
+		return true;
+	#else
+		return false;
+	#endif
+	}
+
+	// Runs func in a forked child and returns the bytes it produced, read from a pipe.
+	// The child starts from a copy of the parent, but everything it allocates or frees stays in the child.
+	// Returns nothing when the child could not be started or did not exit cleanly.
+	[[nodiscard]] static std::optional<std::string> RunInChildProcess(std::function<std::string()> const& func) noexcept
+	{
+	#if defined(__linux__)
+		int fds[2]{};
+		if (pipe(fds) != 0)
+		{
+			std::cerr << "Error: could not create pipe: " << std::strerror(errno) << "\n";
+			return std::nullopt;
+		}
+
+		// Buffered output would otherwise be written by both processes
+		std::cout.flush();
+		std::cerr.flush();
+
+		pid_t const pid{ fork() };
+		if (pid < 0)
+		{
+			std::cerr << "Error: could not fork: " << std::strerror(errno) << "\n";
+			close(fds[0]);
+			close(fds[1]);
+			return std::nullopt;
+		}
+
+		if (pid == 0)
+		{
+			close(fds[0]);
+
+			std::string const payload{ func() };
+			char const* data{ payload.data() };
+			size_t remaining{ payload.size() };
+			while (remaining > 0)
+			{
+				ssize_t const written{ write(fds[1], data, remaining) };
+				if (written < 0)
+				{
+					if (errno == EINTR)
+					{
+						continue;
+					}
+					_exit(1);
+				}
+				data += written;
+				remaining -= static_cast<size_t>(written);
+			}
+			close(fds[1]);
+
+			std::cout.flush();
+			std::cerr.flush();
+
+			// Skip static destructors and atexit handlers, they belong to the parent
+			_exit(0);
+		}
+
+		close(fds[1]);
+
+		std::string payload;
+		char buffer[4096];
+		while (true)
+		{
+			ssize_t const bytesRead{ read(fds[0], buffer, sizeof(buffer)) };
+			if (bytesRead < 0 && errno == EINTR)
+			{
+				continue;
+			}
+			if (bytesRead <= 0)
+			{
+				break;
+			}
+			payload.append(buffer, static_cast<size_t>(bytesRead));
+		}
+		close(fds[0]);
+
+		int status{};
+		while (waitpid(pid, &status, 0) < 0 && errno == EINTR)
+		{
+		}
+
+		if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+		{
+			if (WIFSIGNALED(status))
+			{
+				std::cerr << "Error: benchmark process killed by signal " << WTERMSIG(status) << "\n";
+			}
+			else
+			{
+				std::cerr << "Error: benchmark process exited with status " << WEXITSTATUS(status) << "\n";
+			}
+			return std::nullopt;
+		}
+
+		return payload;
+	#else
+		return func();
+	#endif
+	}
+}
+
+#endif